@@ -5,6 +5,8 @@ import json
 import os
 import tempfile
 import sys
+import threading
+import queue
 
 app = Flask(__name__)
 CORS(app)
@@ -21,12 +23,146 @@ COMPILER_PATHS = [
     'compiler.exe'
 ]
 
+# Seconds a compile may take before it is abandoned with a 408
+COMPILE_TIMEOUT = 5
+
+# Seconds a request waits for an idle compile server before falling back
+# to a one-off compiler process
+SERVER_CHECKOUT_TIMEOUT = 1
+
+# Sections the compiler can emit (`--emit=` / the server's "emit" field)
+EMIT_SECTIONS = ('errors', 'symbols', 'tokens', 'ast')
+
 COMPILER_PATH = None
 for path in COMPILER_PATHS:
     if os.path.exists(path):
         COMPILER_PATH = path
         break
 
+class CompilerServer:
+    """
+    Long-running `compiler --serve` process, used by one request at a time
+    (see CompilerServerPool). Requests and responses are newline-delimited
+    JSON, answered strictly in order. A reader thread queues the responses
+    so each wait can be bounded; a process that times out or answers out
+    of order is killed and restarted.
+    """
+
+    def __init__(self, path):
+        self.path = path
+        self.process = None
+        self.responses = None
+        self.next_id = 0
+
+    def _ensure_started(self):
+        if self.process is None or self.process.poll() is not None:
+            self.process = subprocess.Popen(
+                [self.path, '--serve'],
+                stdin=subprocess.PIPE,
+                stdout=subprocess.PIPE,
+                text=True,
+                bufsize=1
+            )
+            # Each process gets its own queue, so nothing a killed one
+            # wrote can be mistaken for a later response
+            self.responses = queue.Queue()
+            threading.Thread(target=self._read_responses, args=(self.process, self.responses),
+                             daemon=True).start()
+
+    @staticmethod
+    def _read_responses(process, responses):
+        for line in process.stdout:
+            responses.put(line)
+        responses.put('')  # End of output
+
+    def _stop(self):
+        try:
+            self.process.kill()
+        except OSError:
+            pass
+        self.process = None
+
+    def compile(self, source_code, optimize=False, emit=None):
+        self._ensure_started()
+        self.next_id += 1
+        request_id = self.next_id
+        message = {'id': request_id, 'code': source_code, 'optimize': optimize}
+        if emit is not None:
+            message['emit'] = emit
+        try:
+            self.process.stdin.write(json.dumps(message) + '\n')
+            self.process.stdin.flush()
+            line = self.responses.get(timeout=COMPILE_TIMEOUT)
+        except queue.Empty:
+            # Wedged on this source; the fallback would hang on it too
+            self._stop()
+            raise subprocess.TimeoutExpired(self.path, COMPILE_TIMEOUT)
+        except (BrokenPipeError, OSError):
+            line = ''
+        if not line:
+            # Server died; drop it so the next request restarts it
+            self._stop()
+            return None
+        try:
+            output = json.loads(line)
+        except json.JSONDecodeError:
+            output = None
+        if not isinstance(output, dict) or output.get('id') != request_id:
+            # Out of step with the request stream; every later
+            # response would be mismatched too, so start over
+            self._stop()
+            return None
+        if 'error' in output:
+            return None
+        return output
+
+class CompilerServerPool:
+    """
+    A few CompilerServer processes; each request checks one out, so a slow
+    compile only holds up its own request. When every server is busy for
+    SERVER_CHECKOUT_TIMEOUT, compile() returns None and the caller falls
+    back to a one-off process.
+    """
+
+    def __init__(self, path, size):
+        self.idle = queue.Queue()
+        for _ in range(size):
+            self.idle.put(CompilerServer(path))
+
+    def compile(self, source_code, optimize=False, emit=None):
+        try:
+            server = self.idle.get(timeout=SERVER_CHECKOUT_TIMEOUT)
+        except queue.Empty:
+            return None
+        try:
+            return server.compile(source_code, optimize, emit)
+        finally:
+            self.idle.put(server)
+
+# Processes start on first use; COMPILER_SERVE_POOL sets how many
+COMPILER_SERVER = (CompilerServerPool(COMPILER_PATH, int(os.environ.get('COMPILER_SERVE_POOL', min(4, os.cpu_count() or 1))))
+                   if COMPILER_PATH and os.environ.get('COMPILER_SERVE', '1') != '0' else None)
+
+def compile_with_subprocess(source_code, optimize=False, emit=None):
+    """Fallback path: write a temp file and run one compiler process per request"""
+    with tempfile.NamedTemporaryFile(mode='w', suffix='.code', delete=False) as f:
+        f.write(source_code)
+        temp_file = f.name
+    
+    try:
+        result = subprocess.run(
+            [COMPILER_PATH, temp_file, '--json'] + (['-O'] if optimize else []) +
+                ([f"--emit={','.join(emit)}"] if emit is not None else []),
+            capture_output=True,
+            text=True,
+            timeout=COMPILE_TIMEOUT
+        )
+        return json.loads(result.stdout)
+    finally:
+        # Clean up temporary file
+        if os.path.exists(temp_file):
+            os.unlink(temp_file)
+
 @app.route('/api/health', methods=['GET'])
 def health():
     """Health check endpoint"""
@@ -43,8 +179,12 @@ def compile_code():
     Request body:
     {
         "code": "source code",
-        "filename": "optional filename"
+        "filename": "optional filename",
+        "optimize": false  (optional; return the optimized AST),
+        "emit": ["errors", "symbols", "tokens", "ast"]  (optional; sections to return)
     }
+    Sections left out of "emit" are left out of the response; the live
+    check only needs ["errors"].
     """
     try:
         data = request.get_json()
@@ -56,6 +196,15 @@ def compile_code():
         
         source_code = data['code']
         filename = data.get('filename', 'unnamed.code')
+        optimize = bool(data.get('optimize', False))
+        
+        emit = data.get('emit')
+        if isinstance(emit, str):
+            emit = [section for section in emit.split(',') if section]
+        if emit is not None and (not isinstance(emit, list) or any(section not in EMIT_SECTIONS for section in emit)):
+            return jsonify({
+                'error': f'"emit" must list sections from: {", ".join(EMIT_SECTIONS)}'
+            }), 400
         
         # Check if compiler exists
         if not os.path.exists(COMPILER_PATH):
@@ -63,37 +212,22 @@ def compile_code():
                 'error': f'Compiler not found at {COMPILER_PATH}. Please build the C++ compiler first.'
             }), 500
         
-        # Create temporary file with source code
-        with tempfile.NamedTemporaryFile(mode='w', suffix='.code', delete=False) as f:
-            f.write(source_code)
-            temp_file = f.name
+        output = COMPILER_SERVER.compile(source_code, optimize, emit) if COMPILER_SERVER else None
+        if output is None:
+            output = compile_with_subprocess(source_code, optimize, emit)
         
-        try:
-            # Run compiler with JSON output
-            result = subprocess.run(
-                [COMPILER_PATH, temp_file, '--json'],
-                capture_output=True,
-                text=True,
-                timeout=5
-            )
-            
-            # Parse JSON output
-            output = json.loads(result.stdout)
-            
-            return jsonify({
-                'success': not output.get('hasErrors', False),
-                'errors': output.get('errors', []),
-                'symbolTable': output.get('symbolTable', {}),
-                'errorCount': output.get('errorCount', 0),
-                'hasErrors': output.get('hasErrors', False),
-                'tokens': output.get('tokens', []),
-                'ast': output.get('ast', {})
-            })
-        
-        finally:
-            # Clean up temporary file
-            if os.path.exists(temp_file):
-                os.unlink(temp_file)
+        response = {
+            'success': not output.get('hasErrors', False),
+            'errorCount': output.get('errorCount', 0),
+            'hasErrors': output.get('hasErrors', False)
+        }
+        sections = {'errors': [], 'symbolTable': {}, 'tokens': [], 'ast': {}}
+        for key, default in sections.items():
+            if emit is None or key in output:
+                response[key] = output.get(key, default)
+        if 'optimizer' in output:
+            response['optimizer'] = output['optimizer']
+        return jsonify(response)
     
     except subprocess.TimeoutExpired:
         return jsonify({
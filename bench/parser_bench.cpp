@@ -0,0 +1,75 @@
+// Parser benchmark: scans and parses a large synthetic 59LANG program and
+// reports wall time plus the number of heap allocations made while parsing.
+//
+// Usage: parser_bench [statements] [iterations]
+
+#include "../include/parser.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+static std::atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static std::string generateProgram(size_t statements) {
+    std::ostringstream ss;
+    ss << "nexus {\n";
+    ss << "    shard core i = 0, acc = 0;\n";
+    ss << "    shard flux f = 1.5;\n";
+    ss << "    shard sig flag;\n";
+    for (size_t k = 0; k < statements; ++k) {
+        switch (k % 5) {
+            case 0: ss << "    acc = acc + i * 3 - (i / 2);\n"; break;
+            case 1: ss << "    probe (acc > 10 join i < 5) { broadcast \"a long enough message\"; } fallback { i = i + 1; }\n"; break;
+            case 2: ss << "    pulse (i <= 3) { i = i + 1; f = f * 2.0; }\n"; break;
+            case 3: ss << "    flag = void (acc == i) either f >= 2.5;\n"; break;
+            default: ss << "    broadcast acc;\n"; break;
+        }
+    }
+    ss << "}\n";
+    return ss.str();
+}
+
+int main(int argc, char* argv[]) {
+    size_t statements = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 5;
+    
+    auto source = SourceBuffer::fromString(generateProgram(statements));
+    std::cout << "program: " << statements << " statements, "
+              << source->view().size() << " bytes" << std::endl;
+    
+    double bestMs = 0;
+    size_t allocations = 0;
+    for (int it = 0; it < iterations; ++it) {
+        size_t before = allocationCount.load();
+        auto start = std::chrono::steady_clock::now();
+        {
+            Parser parser(source, false);
+            parser.parse();
+            if (parser.hasErrors()) {
+                std::cerr << "unexpected parse errors" << std::endl;
+                return 1;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        if (it == 0 || ms < bestMs) bestMs = ms;
+        allocations = allocationCount.load() - before;
+    }
+    
+    std::cout << "parse: best " << bestMs << " ms over " << iterations << " runs, "
+              << allocations << " allocations per parse" << std::endl;
+    return 0;
+}
@@ -0,0 +1,132 @@
+// VM benchmark: runs loop-heavy 59LANG programs compiled with generic and
+// with type-specialized opcodes, under both interpreter dispatch modes
+// (switch and direct-threaded), and reports the best wall time of each.
+//
+// Usage: vm_bench [scale] [iterations]
+
+#include "../include/parser.h"
+#include "../include/bytecode_compiler.h"
+#include "../include/vm.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+struct BenchProgram {
+    const char* name;
+    std::string source;
+};
+
+static BenchProgram countingLoop(long scale) {
+    std::ostringstream ss;
+    ss << "nexus {\n"
+       << "    shard core i = 0;\n"
+       << "    pulse (i < " << 10000000 * scale << ") {\n"
+       << "        i = i + 1;\n"
+       << "    }\n"
+       << "    broadcast i;\n"
+       << "}\n";
+    return {"counting loop", ss.str()};
+}
+
+// The factorial example from backend/app.py, repeated in an outer loop
+static BenchProgram factorialLoop(long scale) {
+    std::ostringstream ss;
+    ss << "nexus {\n"
+       << "    shard core round = 0, factorial = 1, i = 1, n = 20;\n"
+       << "    pulse (round < " << 250000 * scale << ") {\n"
+       << "        factorial = 1;\n"
+       << "        i = 1;\n"
+       << "        pulse (i <= n) {\n"
+       << "            factorial = factorial * i;\n"
+       << "            i = i + 1;\n"
+       << "        }\n"
+       << "        round = round + 1;\n"
+       << "    }\n"
+       << "    broadcast factorial;\n"
+       << "}\n";
+    return {"factorial", ss.str()};
+}
+
+static BenchProgram mixedLoop(long scale) {
+    std::ostringstream ss;
+    ss << "nexus {\n"
+       << "    shard core i = 0, evens = 0;\n"
+       << "    shard flux total = 0.0;\n"
+       << "    pulse (i < " << 3000000 * scale << ") {\n"
+       << "        probe (i - (i / 2) * 2 == 0 join i > 10) {\n"
+       << "            evens = evens + 1;\n"
+       << "        } fallback {\n"
+       << "            total = total + i * 0.5;\n"
+       << "        }\n"
+       << "        i = i + 1;\n"
+       << "    }\n"
+       << "    broadcast evens;\n"
+       << "    broadcast total;\n"
+       << "}\n";
+    return {"mixed int/float", ss.str()};
+}
+
+static double timeRun(const Chunk& chunk, VM::Dispatch mode, std::string& output) {
+    std::istringstream in;
+    std::ostringstream out;
+    VM vm(chunk, in, out);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = vm.run(mode);
+    auto end = std::chrono::steady_clock::now();
+
+    if (!ok) {
+        std::cerr << "runtime error: " << vm.getError()->message << std::endl;
+        std::exit(1);
+    }
+    output = out.str();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    long scale = argc > 1 ? std::strtol(argv[1], nullptr, 10) : 1;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    std::cout << "default dispatch: "
+              << (VM::defaultDispatch() == VM::Dispatch::Threaded ? "threaded" : "switch") << std::endl;
+
+    for (const BenchProgram& program : {countingLoop(scale), factorialLoop(scale), mixedLoop(scale)}) {
+        Parser parser(program.source, false);
+        ASTNodePtr ast = parser.parse();
+        if (parser.hasErrors()) {
+            std::cerr << program.name << ": unexpected parse errors" << std::endl;
+            return 1;
+        }
+        // Index: specialized * 2 + dispatch mode
+        Chunk chunks[2] = {BytecodeCompiler(true, false).compile(ast), BytecodeCompiler(true, true).compile(ast)};
+
+        double best[4] = {0, 0, 0, 0};
+        std::string outputs[4];
+        for (int it = 0; it < iterations; ++it) {
+            // Alternate variants so all see the same machine conditions
+            for (int variant = 0; variant < 4; ++variant) {
+                VM::Dispatch dispatch = variant % 2 == 0 ? VM::Dispatch::Switch : VM::Dispatch::Threaded;
+                double ms = timeRun(chunks[variant / 2], dispatch, outputs[variant]);
+                if (it == 0 || ms < best[variant]) best[variant] = ms;
+            }
+        }
+
+        for (int variant = 1; variant < 4; ++variant) {
+            if (outputs[variant] != outputs[0]) {
+                std::cerr << program.name << ": variants disagree" << std::endl;
+                return 1;
+            }
+        }
+
+        std::cout << program.name << " (" << chunks[0].code.size() << " -> " << chunks[1].code.size()
+                  << " instructions)" << std::endl;
+        for (int mode = 0; mode < 2; ++mode) {
+            std::cout << "  " << (mode == 0 ? "switch:   " : "threaded: ") << "generic " << best[mode]
+                      << " ms, specialized " << best[2 + mode] << " ms (" << best[mode] / best[2 + mode] << "x)"
+                      << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#ifndef ASM_GENERATOR_H
+#define ASM_GENERATOR_H
+
+#include "ast_node.h"
+#include "bytecode.h"
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Translates a parsed Program into x86-64 System V assembly (GNU as, AT&T
+// syntax) defining `main`. I/O, string handling and runtime errors are
+// calls into runtime/runtime.c:
+//
+//     compiler program.code --emit-asm program.s
+//     cc program.s runtime/runtime.c -lm -o program
+//
+// Variables live in the stack frame; expressions are evaluated into %rax
+// (int, bool, string pointer) or %xmm0 (float), spilling left operands to
+// the machine stack. Expression types are the TypeChecker's annotations
+// (checkedType()), so the AST must be checked and free of errors;
+// unsupported input throws std::runtime_error.
+class AsmGenerator : public ASTVisitor<AsmGenerator, ValueType> {
+public:
+    void generate(ASTNodePtr program, std::ostream& out);
+
+    // Expressions return their static type; statements return Int (unused)
+    ValueType visitNode(ASTNodePtr node);
+    ValueType visitProgram(Program* p);
+    ValueType visitDeclaration(Declaration* d);
+    ValueType visitAssignment(Assignment* a);
+    ValueType visitBinaryOp(BinaryOp* b);
+    ValueType visitUnaryOp(UnaryOp* u);
+    ValueType visitLiteral(Literal* l);
+    ValueType visitIdentifier(Identifier* id);
+    ValueType visitFunctionCall(FunctionCall* f);
+    ValueType visitIfStatement(IfStatement* iff);
+    ValueType visitWhileLoop(WhileLoop* w);
+    ValueType visitForLoop(ForLoop* f);
+    ValueType visitReturnStatement(ReturnStatement* r);
+
+private:
+    struct Variable {
+        std::string name;
+        int32_t offset;  // From %rbp
+        ValueType type;
+    };
+
+    std::ostringstream body;
+    std::unordered_map<std::string_view, Variable> variables;
+    std::vector<std::string> strings;  // .rodata string literals (.LS<n>)
+    std::vector<double> floats;        // .rodata float constants (.LF<n>)
+    int labelCount = 0;
+    int pushDepth = 0;  // 8-byte temporaries currently on the machine stack
+    bool flagsRequested = false;  // branchIfFalse accepts a comparison result in the flags
+    std::string flagsCondition;   // Set when it was left there (condition-code suffix)
+
+    void emit(const std::string& instruction);
+    std::string newLabel();
+    void placeLabel(const std::string& label);
+    void push(ValueType type);
+    void popInto(ValueType type, ValueType as);  // Left operand into %rax/%xmm0
+    void call(const char* function);
+    void convert(ValueType from, ValueType to);
+    void toBool(ValueType type);
+    void toString(ValueType type);
+    void store(const Variable& variable);
+    void branchIfFalse(ASTNodePtr condition, const std::string& target);
+    void compileBlock(const ASTNodeList& statements);
+    void divide(bool modulo);
+    ValueType intBinary(std::string_view op, bool wantFlags);
+    bool directIntOperand(ASTNodePtr node, std::string& operand) const;
+    const Variable& variableFor(std::string_view name) const;
+    std::string stringLabel(std::string_view text);
+    std::string floatLabel(double value);
+};
+
+#endif // ASM_GENERATOR_H
@@ -0,0 +1,49 @@
+#ifndef AST_ARENA_H
+#define AST_ARENA_H
+
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <type_traits>
+
+// Bump allocator owning every AST node of one compilation unit.
+//
+// Nodes and their child lists are carved out of a few large blocks, and the
+// whole tree is released at once when the arena is destroyed. Node destructors
+// are never run: every node member is either trivially destructible or a
+// container allocated from this same arena, so there is nothing to free.
+class AstArena {
+private:
+    static constexpr size_t INITIAL_BLOCK_SIZE = 64 * 1024;
+    std::pmr::monotonic_buffer_resource resource;
+    
+public:
+    AstArena() : resource(INITIAL_BLOCK_SIZE) {}
+    AstArena(const AstArena&) = delete;
+    AstArena& operator=(const AstArena&) = delete;
+    
+    // Construct a node in the arena. Nodes holding child lists take the
+    // arena's memory resource so the lists allocate from it as well.
+    template <typename T>
+    T* make() {
+        void* mem = resource.allocate(sizeof(T), alignof(T));
+        if constexpr (std::is_constructible_v<T, std::pmr::memory_resource*>) {
+            return new (mem) T(&resource);
+        } else {
+            return new (mem) T();
+        }
+    }
+    
+    // Copy a string into the arena so AST nodes can hold a view of it
+    std::string_view copyString(std::string_view str) {
+        if (str.empty()) return {};
+        char* mem = static_cast<char*>(resource.allocate(str.size(), 1));
+        std::memcpy(mem, str.data(), str.size());
+        return std::string_view(mem, str.size());
+    }
+    
+    std::pmr::memory_resource* getResource() { return &resource; }
+};
+
+#endif // AST_ARENA_H
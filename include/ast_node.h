@@ -1,130 +1,286 @@
 #ifndef AST_NODE_H
 #define AST_NODE_H
 
+#include "value_type.h"
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <memory_resource>
 #include <vector>
-#include <memory>
-#include <variant>
 
 // Forward declarations
 struct ASTNode;
-using ASTNodePtr = std::shared_ptr<ASTNode>;
-using ASTNodeList = std::vector<ASTNodePtr>;
+
+// Nodes live in the parser's AstArena; pointers are non-owning and stay valid
+// for as long as the Parser that produced them.
+using ASTNodePtr = ASTNode*;
+using ASTNodeList = std::pmr::vector<ASTNodePtr>;
+
+// Compact tag identifying the concrete node type; used for switch-based
+// dispatch instead of comparing type-name strings.
+enum class NodeKind : uint8_t {
+    Program, Declaration, Assignment, BinaryOp, UnaryOp, Literal, Identifier,
+    FunctionCall, IfStatement, WhileLoop, ForLoop, ReturnStatement, Function
+};
+
+const char* nodeKindToString(NodeKind kind);
 
 struct ASTNode {
+    const NodeKind kind;
+    std::optional<ValueType> valueType;  // Expressions: set by TypeChecker
+    int line = 0;                        // Source position for diagnostics
+    int column = 0;                      // (0 for nodes made by optimizer passes)
+    
+    explicit ASTNode(NodeKind k) : kind(k) {}
     virtual ~ASTNode() = default;
-    virtual std::string getType() const = 0;
     virtual std::string toString() const = 0;
 };
 
 struct Program : ASTNode {
-    std::string name;
+    static constexpr NodeKind Kind = NodeKind::Program;
+    std::string_view name;
     ASTNodeList declarations;
     ASTNodeList statements;
     
-    std::string getType() const override { return "Program"; }
+    explicit Program(std::pmr::memory_resource* mr) : ASTNode(Kind), declarations(mr), statements(mr) {}
+    
     std::string toString() const override;
 };
 
 struct Declaration : ASTNode {
-    std::string dataType;
-    std::vector<std::string> identifiers;
-    std::vector<ASTNodePtr> initializers;  // Optional initialization expressions (nullptr if not initialized)
+    static constexpr NodeKind Kind = NodeKind::Declaration;
+    std::string_view dataType;
+    std::pmr::vector<std::string_view> identifiers;
+    ASTNodeList initializers;  // Optional initialization expressions (nullptr if not initialized)
+    
+    explicit Declaration(std::pmr::memory_resource* mr) : ASTNode(Kind), identifiers(mr), initializers(mr) {}
     
-    std::string getType() const override { return "Declaration"; }
     std::string toString() const override;
 };
 
 struct Assignment : ASTNode {
-    std::string identifier;
-    ASTNodePtr expression;
+    static constexpr NodeKind Kind = NodeKind::Assignment;
+    std::string_view identifier;
+    ASTNodePtr expression = nullptr;
+    
+    Assignment() : ASTNode(Kind) {}
     
-    std::string getType() const override { return "Assignment"; }
     std::string toString() const override;
 };
 
 struct BinaryOp : ASTNode {
-    std::string operation;
-    ASTNodePtr left;
-    ASTNodePtr right;
+    static constexpr NodeKind Kind = NodeKind::BinaryOp;
+    std::string_view operation;
+    ASTNodePtr left = nullptr;
+    ASTNodePtr right = nullptr;
+    
+    BinaryOp() : ASTNode(Kind) {}
     
-    std::string getType() const override { return "BinaryOp"; }
     std::string toString() const override;
 };
 
 struct UnaryOp : ASTNode {
-    std::string operation;
-    ASTNodePtr operand;
+    static constexpr NodeKind Kind = NodeKind::UnaryOp;
+    std::string_view operation;
+    ASTNodePtr operand = nullptr;
+    
+    UnaryOp() : ASTNode(Kind) {}
     
-    std::string getType() const override { return "UnaryOp"; }
     std::string toString() const override;
 };
 
 struct Literal : ASTNode {
-    std::string value;
-    std::string dataType;
+    static constexpr NodeKind Kind = NodeKind::Literal;
+    std::string_view value;
+    std::string_view dataType;
+    
+    Literal() : ASTNode(Kind) {}
     
-    std::string getType() const override { return "Literal"; }
     std::string toString() const override;
 };
 
 struct Identifier : ASTNode {
-    std::string name;
+    static constexpr NodeKind Kind = NodeKind::Identifier;
+    std::string_view name;
+    
+    Identifier() : ASTNode(Kind) {}
     
-    std::string getType() const override { return "Identifier"; }
     std::string toString() const override;
 };
 
 struct FunctionCall : ASTNode {
-    std::string functionName;
+    static constexpr NodeKind Kind = NodeKind::FunctionCall;
+    std::string_view functionName;
     ASTNodeList arguments;
     
-    std::string getType() const override { return "FunctionCall"; }
+    explicit FunctionCall(std::pmr::memory_resource* mr) : ASTNode(Kind), arguments(mr) {}
+    
     std::string toString() const override;
 };
 
 struct IfStatement : ASTNode {
-    ASTNodePtr condition;
+    static constexpr NodeKind Kind = NodeKind::IfStatement;
+    ASTNodePtr condition = nullptr;
     ASTNodeList thenBranch;
     ASTNodeList elseBranch;
     
-    std::string getType() const override { return "IfStatement"; }
+    explicit IfStatement(std::pmr::memory_resource* mr) : ASTNode(Kind), thenBranch(mr), elseBranch(mr) {}
+    
     std::string toString() const override;
 };
 
 struct WhileLoop : ASTNode {
-    ASTNodePtr condition;
+    static constexpr NodeKind Kind = NodeKind::WhileLoop;
+    ASTNodePtr condition = nullptr;
     ASTNodeList body;
     
-    std::string getType() const override { return "WhileLoop"; }
+    explicit WhileLoop(std::pmr::memory_resource* mr) : ASTNode(Kind), body(mr) {}
+    
     std::string toString() const override;
 };
 
 struct ForLoop : ASTNode {
-    ASTNodePtr initialization;
-    ASTNodePtr condition;
-    ASTNodePtr increment;
+    static constexpr NodeKind Kind = NodeKind::ForLoop;
+    ASTNodePtr initialization = nullptr;
+    ASTNodePtr condition = nullptr;
+    ASTNodePtr increment = nullptr;
     ASTNodeList body;
     
-    std::string getType() const override { return "ForLoop"; }
+    explicit ForLoop(std::pmr::memory_resource* mr) : ASTNode(Kind), body(mr) {}
+    
     std::string toString() const override;
 };
 
 struct ReturnStatement : ASTNode {
-    ASTNodePtr expression;
+    static constexpr NodeKind Kind = NodeKind::ReturnStatement;
+    ASTNodePtr expression = nullptr;
+    
+    ReturnStatement() : ASTNode(Kind) {}
     
-    std::string getType() const override { return "ReturnStatement"; }
     std::string toString() const override;
 };
 
 struct Function : ASTNode {
-    std::string name;
-    std::string returnType;
+    static constexpr NodeKind Kind = NodeKind::Function;
+    std::string_view name;
+    std::string_view returnType;
     ASTNodeList parameters;
     ASTNodeList body;
     
-    std::string getType() const override { return "Function"; }
+    explicit Function(std::pmr::memory_resource* mr) : ASTNode(Kind), parameters(mr), body(mr) {}
+    
     std::string toString() const override;
 };
 
+// Checked downcast: returns nullptr unless `node` is a T
+template <typename T>
+T* nodeAs(ASTNodePtr node) {
+    return (node && node->kind == T::Kind) ? static_cast<T*>(node) : nullptr;
+}
+
+// Switch-based visitor. Derive as `struct Pass : ASTVisitor<Pass, R>` and
+// define the visitX methods you need; the rest fall through to visitNode().
+// Dispatch is a single switch on NodeKind with no virtual calls.
+template <typename Derived, typename R = void>
+class ASTVisitor {
+public:
+    R visit(ASTNodePtr node) {
+        Derived& self = static_cast<Derived&>(*this);
+        switch (node->kind) {
+            case NodeKind::Program: return self.visitProgram(static_cast<Program*>(node));
+            case NodeKind::Declaration: return self.visitDeclaration(static_cast<Declaration*>(node));
+            case NodeKind::Assignment: return self.visitAssignment(static_cast<Assignment*>(node));
+            case NodeKind::BinaryOp: return self.visitBinaryOp(static_cast<BinaryOp*>(node));
+            case NodeKind::UnaryOp: return self.visitUnaryOp(static_cast<UnaryOp*>(node));
+            case NodeKind::Literal: return self.visitLiteral(static_cast<Literal*>(node));
+            case NodeKind::Identifier: return self.visitIdentifier(static_cast<Identifier*>(node));
+            case NodeKind::FunctionCall: return self.visitFunctionCall(static_cast<FunctionCall*>(node));
+            case NodeKind::IfStatement: return self.visitIfStatement(static_cast<IfStatement*>(node));
+            case NodeKind::WhileLoop: return self.visitWhileLoop(static_cast<WhileLoop*>(node));
+            case NodeKind::ForLoop: return self.visitForLoop(static_cast<ForLoop*>(node));
+            case NodeKind::ReturnStatement: return self.visitReturnStatement(static_cast<ReturnStatement*>(node));
+            case NodeKind::Function: return self.visitFunction(static_cast<Function*>(node));
+        }
+        return self.visitNode(node);
+    }
+    
+    R visitNode(ASTNodePtr) { return R(); }
+    R visitProgram(Program* n) { return static_cast<Derived&>(*this).visitNode(n); }
+    R visitDeclaration(Declaration* n) { return static_cast<Derived&>(*this).visitNode(n); }
+    R visitAssignment(Assignment* n) { return static_cast<Derived&>(*this).visitNode(n); }
+    R visitBinaryOp(BinaryOp* n) { return static_cast<Derived&>(*this).visitNode(n); }
+    R visitUnaryOp(UnaryOp* n) { return static_cast<Derived&>(*this).visitNode(n); }
+    R visitLiteral(Literal* n) { return static_cast<Derived&>(*this).visitNode(n); }
+    R visitIdentifier(Identifier* n) { return static_cast<Derived&>(*this).visitNode(n); }
+    R visitFunctionCall(FunctionCall* n) { return static_cast<Derived&>(*this).visitNode(n); }
+    R visitIfStatement(IfStatement* n) { return static_cast<Derived&>(*this).visitNode(n); }
+    R visitWhileLoop(WhileLoop* n) { return static_cast<Derived&>(*this).visitNode(n); }
+    R visitForLoop(ForLoop* n) { return static_cast<Derived&>(*this).visitNode(n); }
+    R visitReturnStatement(ReturnStatement* n) { return static_cast<Derived&>(*this).visitNode(n); }
+    R visitFunction(Function* n) { return static_cast<Derived&>(*this).visitNode(n); }
+};
+
+// Call fn(child) for every non-null direct child of `node`, in source order
+template <typename F>
+void forEachChild(ASTNodePtr node, F&& fn) {
+    auto each = [&fn](const ASTNodeList& list) {
+        for (ASTNodePtr child : list) {
+            if (child) fn(child);
+        }
+    };
+    auto one = [&fn](ASTNodePtr child) {
+        if (child) fn(child);
+    };
+    
+    switch (node->kind) {
+        case NodeKind::Program: {
+            auto p = static_cast<Program*>(node);
+            each(p->declarations);
+            each(p->statements);
+            break;
+        }
+        case NodeKind::Declaration: each(static_cast<Declaration*>(node)->initializers); break;
+        case NodeKind::Assignment: one(static_cast<Assignment*>(node)->expression); break;
+        case NodeKind::BinaryOp: {
+            auto b = static_cast<BinaryOp*>(node);
+            one(b->left);
+            one(b->right);
+            break;
+        }
+        case NodeKind::UnaryOp: one(static_cast<UnaryOp*>(node)->operand); break;
+        case NodeKind::Literal: break;
+        case NodeKind::Identifier: break;
+        case NodeKind::FunctionCall: each(static_cast<FunctionCall*>(node)->arguments); break;
+        case NodeKind::IfStatement: {
+            auto i = static_cast<IfStatement*>(node);
+            one(i->condition);
+            each(i->thenBranch);
+            each(i->elseBranch);
+            break;
+        }
+        case NodeKind::WhileLoop: {
+            auto w = static_cast<WhileLoop*>(node);
+            one(w->condition);
+            each(w->body);
+            break;
+        }
+        case NodeKind::ForLoop: {
+            auto f = static_cast<ForLoop*>(node);
+            one(f->initialization);
+            one(f->condition);
+            one(f->increment);
+            each(f->body);
+            break;
+        }
+        case NodeKind::ReturnStatement: one(static_cast<ReturnStatement*>(node)->expression); break;
+        case NodeKind::Function: {
+            auto func = static_cast<Function*>(node);
+            each(func->parameters);
+            each(func->body);
+            break;
+        }
+    }
+}
+
 #endif // AST_NODE_H
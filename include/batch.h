@@ -0,0 +1,24 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "compile_cache.h"
+#include <ostream>
+#include <string>
+
+// Batch compilation driver
+// (`compiler --batch <dir> [-j N] [--pretty] [--cache-size MiB] [--cache-dir <dir>]`).
+//
+// Recursively collects every `.code` file under `directory`, compiles them on
+// a pool of `jobs` worker threads (one Parser per file, nothing shared between
+// tasks) and writes a single aggregated JSON report to `out`, compact unless
+// `pretty`. Files with identical contents are parsed once: diagnostics are
+// kept in an LRU cache of up to `cacheBytes`, and the report's "cache"
+// object counts its hits and misses. With a `cacheDir` diagnostics also
+// persist there between runs (see DiskCache), so an unchanged file is only
+// read and hashed. Each file's "errorCount" is the length of its "errors";
+// a file that cannot be read has none and an "ioError" message instead.
+// Returns 0 when every file compiled cleanly, 1 otherwise.
+int runBatch(const std::string& directory, unsigned jobs, std::ostream& out, bool pretty = false,
+             size_t cacheBytes = DEFAULT_CACHE_BYTES, const std::string& cacheDir = "");
+
+#endif // BATCH_H
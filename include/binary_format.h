@@ -0,0 +1,135 @@
+#ifndef BINARY_FORMAT_H
+#define BINARY_FORMAT_H
+
+#include "ast_node.h"
+#include "error.h"
+#include "source_buffer.h"
+#include "token.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Binary form of the token stream, AST and diagnostics (`--emit-binary`).
+//
+// The file is a header followed by flat tables of fixed-size records, all
+// little-endian and 4-byte aligned, so a reader can index straight into a
+// memory-mapped file without a parse step:
+//
+//   header    magic "59AB", u16 version, u16 flags (bit 0: source had
+//             errors), u32 file size, u32 root node, then {u32 offset,
+//             u32 count} for each table: tokens, nodes, children, errors,
+//             strings (count in bytes)
+//   token     u32 TokenType, u32 line, u32 column, str value          20 bytes
+//   node      u8 NodeKind, u8 ValueType + 1 (0: untyped), u16 0,
+//             u32 line, u32 column, u32 split, str text, str text2,
+//             u32 first child, u32 child count                        40 bytes
+//   child     u32 node index, NO_NODE for an absent optional child
+//   error     u32 ErrorType, u32 line, u32 column, str message        20 bytes
+//
+// where str is {u32 offset, u32 length} into the string table (not NUL
+// terminated). Node fields by kind:
+//
+//   Program          text name; children declarations then statements,
+//                    split = number of declarations
+//   Declaration      text data type; children are (Identifier, initializer
+//                    or NO_NODE) pairs, one per declared name
+//   Assignment       text identifier; children [expression]
+//   BinaryOp         text operator; children [left, right]
+//   UnaryOp          text operator; children [operand]
+//   Literal          text value, text2 data type
+//   Identifier       text name
+//   FunctionCall     text function name; children arguments
+//   IfStatement      children condition, then branch, else branch;
+//                    split = length of the then branch
+//   WhileLoop        children condition, body
+//   ForLoop          children initialization, condition, increment, body
+//   ReturnStatement  children [expression]
+//   Function         text name, text2 return type; children parameters
+//                    then body, split = number of parameters
+//
+// The enums are stored by value, so reordering TokenType, NodeKind,
+// ValueType or ErrorType requires a new BINARY_FORMAT_VERSION.
+constexpr uint16_t BINARY_FORMAT_VERSION = 1;
+constexpr uint32_t NO_NODE = 0xFFFFFFFF;
+
+// Write the binary form of a parse; `ast` may be null
+void writeBinary(std::ostream& out, const std::vector<Token>& tokens, ASTNodePtr ast,
+                 const std::vector<std::shared_ptr<Error>>& errors);
+
+struct BinaryToken {
+    TokenType type;
+    std::string_view value;
+    int line;
+    int column;
+};
+
+struct BinaryNode {
+    uint32_t index;
+    NodeKind kind;
+    std::optional<ValueType> valueType;
+    int line;
+    int column;
+    uint32_t split;
+    std::string_view text;
+    std::string_view text2;
+    uint32_t firstChild;
+    uint32_t childCount;
+};
+
+struct BinaryError {
+    ErrorType type;
+    std::string_view message;
+    int line;
+    int column;
+};
+
+// Zero-copy view of a binary file. The constructor checks the header and
+// that every table lies inside the data; records are decoded on access,
+// and string and node references are bounds-checked as they are followed.
+// Malformed input throws std::runtime_error. Views returned by the
+// accessors point into the data and live as long as it does.
+class BinaryReader {
+public:
+    BinaryReader(const char* data, size_t size);
+
+    // Memory-map `path` (read into memory where mapping is unavailable)
+    static BinaryReader fromFile(const std::string& path);
+
+    bool hasErrors() const { return flags & 1; }
+    uint16_t getVersion() const { return version; }
+
+    size_t tokenCount() const { return tokens.count; }
+    BinaryToken token(size_t index) const;
+
+    size_t nodeCount() const { return nodes.count; }
+    uint32_t root() const { return rootNode; }  // NO_NODE if there is no AST
+    BinaryNode node(uint32_t index) const;
+    // May be NO_NODE; children always follow their parent, so walks end
+    uint32_t child(const BinaryNode& n, size_t index) const;
+
+    size_t errorCount() const { return errors.count; }
+    BinaryError error(size_t index) const;
+
+private:
+    struct Table {
+        uint32_t offset = 0;
+        uint32_t count = 0;
+    };
+
+    std::shared_ptr<const SourceBuffer> file;  // Keeps a mapped file alive
+    const char* data;
+    size_t size;
+    uint16_t version = 0;
+    uint16_t flags = 0;
+    uint32_t rootNode = NO_NODE;
+    Table tokens, nodes, children, errors, strings;
+
+    const char* record(const Table& table, size_t index, size_t recordSize) const;
+    std::string_view string(const char* ref) const;
+};
+
+#endif // BINARY_FORMAT_H
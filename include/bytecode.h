@@ -0,0 +1,110 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include "value_type.h"
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Tagged value; trivially copyable so the VM stack is a plain array.
+// Strings point into storage owned by the Chunk (constants) or the VM
+// (input and concatenation results) and live until the run ends.
+struct Value {
+    ValueType type;
+    union {
+        int64_t i;
+        double f;
+        bool b;
+        const std::string* s;
+    };
+
+    Value() : type(ValueType::Int), i(0) {}
+    static Value ofInt(int64_t v) { Value r; r.type = ValueType::Int; r.i = v; return r; }
+    static Value ofFloat(double v) { Value r; r.type = ValueType::Float; r.f = v; return r; }
+    static Value ofBool(bool v) { Value r; r.type = ValueType::Bool; r.b = v; return r; }
+    static Value ofString(const std::string* v) { Value r; r.type = ValueType::String; r.s = v; return r; }
+};
+
+// Text used by broadcast: ints in decimal, floats with up to 15 significant
+// digits, bools as true/false, strings verbatim
+std::string valueToString(const Value& value);
+
+enum class OpCode : uint8_t {
+    PushConst,    // push constants[a]
+    Load,         // push slots[a]
+    Store,        // pop into slots[a], converting to the slot's declared type
+    Pop,
+    Add, Sub, Mul, Div, Mod, Pow,
+    Neg, Not,
+    Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual,
+    Jump,         // pc = a
+    JumpIfFalse,  // pop; if falsy, pc = a
+    JumpIfTrue,   // pop; if truthy, pc = a
+    Print,        // pop and write with a trailing newline
+    Read,         // read one line of input into slots[a]
+    Halt,
+
+    // Superinstructions fused by the BytecodeCompiler from common shapes
+    IncLocal,           // x = x + c:  slots[a] += constants[b]
+    CmpLocalConstJump,  // guard x < c: if !(slots[a] <cmp> constants[b]), pc = c
+    PrintLocal,         // broadcast x: print slots[a]
+
+    // Type-specialized forms, selected from the type checker's annotations.
+    // They trust their operands' static types and never inspect value tags.
+    AddInt, SubInt, MulInt, DivInt, ModInt,  // core op core (wrapping; / and % check for 0)
+    AddFloat, SubFloat, MulFloat, DivFloat,  // flux op flux
+    NegInt, NegFloat,
+    NotBool,
+    ToFloat,            // core on top of the stack -> flux
+    CompareInt,         // pop b, a; push a <cmp> b
+    CompareFloat,
+    StoreDirect,        // pop into slots[a]; the value already has the slot's type
+    JumpIfFalseBool,    // pop a sig; if false, pc = a
+    JumpIfTrueBool,
+    CmpIntJump,         // core guard a < b: pop b, a; if !(a <cmp> b), pc = a
+    IncLocalInt,        // core x = x + c
+    CmpLocalConstJumpInt  // core guard x < c
+};
+
+constexpr size_t OPCODE_COUNT = static_cast<size_t>(OpCode::CmpLocalConstJumpInt) + 1;
+
+const char* opCodeToString(OpCode op);
+
+// Number of generic instructions a superinstruction replaces, minus one
+// (i.e. dispatches saved each time it runs); 0 for ordinary opcodes
+int fusedInstructionSavings(OpCode op);
+
+struct Instruction {
+    OpCode op;
+    OpCode cmp;  // Comparison performed by CmpLocalConstJump(Int), Compare*, CmpIntJump
+    int32_t a;
+    int32_t b;   // Extra operands of superinstructions
+    int32_t c;
+
+    Instruction(OpCode o, int32_t operand = 0, int32_t second = 0, int32_t third = 0)
+        : op(o), cmp(OpCode::Halt), a(operand), b(second), c(third) {}
+};
+
+// A compiled program: flat instruction stream plus the tables it indexes.
+// Movable but not copyable (constants point into `strings`).
+struct Chunk {
+    std::vector<Instruction> code;
+    std::vector<Value> constants;
+    std::deque<std::string> strings;       // Backing store for string constants
+    std::vector<std::string> slotNames;    // One slot per declared variable
+    std::vector<ValueType> slotTypes;
+    size_t maxStack = 0;                   // Deepest operand stack the code can reach
+
+    Chunk() = default;
+    Chunk(Chunk&&) = default;
+    Chunk& operator=(Chunk&&) = default;
+    Chunk(const Chunk&) = delete;
+    Chunk& operator=(const Chunk&) = delete;
+};
+
+// Human-readable listing, one instruction per line
+void disassemble(const Chunk& chunk, std::ostream& out);
+
+#endif // BYTECODE_H
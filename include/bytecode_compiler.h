@@ -0,0 +1,68 @@
+#ifndef BYTECODE_COMPILER_H
+#define BYTECODE_COMPILER_H
+
+#include "ast_node.h"
+#include "bytecode.h"
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+// Lowers a parsed Program into a Chunk for the VM. The AST must be free of
+// errors (Parser::hasErrors() == false); unsupported input throws
+// std::runtime_error.
+//
+// With fusion enabled, common statement shapes become superinstructions:
+//   x = x + c;  x = x - c;   -> INC_LOCAL            (numeric x, numeric literal c)
+//   probe/pulse/cycle (x < c) -> CMP_LOCAL_CONST_JUMP (any comparison, any literal c)
+//   broadcast x;             -> PRINT_LOCAL
+//
+// With specialization enabled, the types the TypeChecker recorded on the
+// AST select typed opcodes that skip the VM's tag checks: core and flux
+// arithmetic and comparisons (ADD_INT, CMP_FLOAT, ...; an int operand of a
+// flux operation is converted with TO_FLOAT), sig conditions, stores whose
+// value already has the variable's type, and core guards (CMP_INT_JUMP).
+// Unannotated expressions, glyph and sig operands, ** and flux % stay generic.
+class BytecodeCompiler : public ASTVisitor<BytecodeCompiler> {
+public:
+    explicit BytecodeCompiler(bool fuseInstructions = true, bool specializeTypes = true)
+        : fuse(fuseInstructions), specialize(specializeTypes) {}
+    Chunk compile(ASTNodePtr program);
+
+    void visitNode(ASTNodePtr node);
+    void visitProgram(Program* p);
+    void visitDeclaration(Declaration* d);
+    void visitAssignment(Assignment* a);
+    void visitBinaryOp(BinaryOp* b);
+    void visitUnaryOp(UnaryOp* u);
+    void visitLiteral(Literal* l);
+    void visitIdentifier(Identifier* id);
+    void visitFunctionCall(FunctionCall* f);
+    void visitIfStatement(IfStatement* iff);
+    void visitWhileLoop(WhileLoop* w);
+    void visitForLoop(ForLoop* f);
+    void visitReturnStatement(ReturnStatement* r);
+
+private:
+    bool fuse;
+    bool specialize;
+    Chunk chunk;
+    std::unordered_map<std::string_view, int32_t> slots;
+    size_t depth = 0;  // Operand stack depth at the current emit point
+
+    size_t emit(OpCode op, int32_t a = 0, int32_t b = 0);
+    size_t here() const { return chunk.code.size(); }
+    void patchJump(size_t at);  // Point the jump at `at` to the next instruction
+    void adjustDepth(int delta);
+    int32_t addConstant(Value value);
+    int32_t declareSlot(std::string_view name, ValueType type);
+    int32_t slotFor(std::string_view name) const;
+    void compileBlock(const ASTNodeList& statements);
+    size_t compileCondition(ASTNodePtr condition);  // Returns the jump taken when false
+    bool fuseIncrement(Assignment* a);
+    std::optional<ValueType> staticType(ASTNodePtr expression) const;
+    bool compileTypedBinary(BinaryOp* b, OpCode generic);
+    void compileStore(ASTNodePtr value, int32_t slot);
+    Value literalValue(Literal* l);
+};
+
+#endif // BYTECODE_COMPILER_H
@@ -0,0 +1,66 @@
+#ifndef C_GENERATOR_H
+#define C_GENERATOR_H
+
+#include "ast_node.h"
+#include "bytecode.h"
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// A C expression and its static type
+struct CExpression {
+    std::string code;
+    ValueType type = ValueType::Int;
+};
+
+// Translates a parsed Program into a self-contained C99 translation unit.
+// The runtime (I/O, string formatting, checked division) is runtime/runtime.c,
+// the file the assembly backend links against, embedded at build time, so
+// the output builds with any C compiler:
+//
+//     compiler program.code --emit-c program.c
+//     cc -O2 program.c -lm -o program
+//
+// Expression types are the TypeChecker's annotations (checkedType()), so the
+// AST must be checked and free of errors.
+class CGenerator : public ASTVisitor<CGenerator, CExpression> {
+public:
+    void generate(ASTNodePtr program, std::ostream& out);
+
+    // Expressions return their C text; statements write to `body` and
+    // return an empty expression
+    CExpression visitNode(ASTNodePtr node);
+    CExpression visitProgram(Program* p);
+    CExpression visitDeclaration(Declaration* d);
+    CExpression visitAssignment(Assignment* a);
+    CExpression visitBinaryOp(BinaryOp* b);
+    CExpression visitUnaryOp(UnaryOp* u);
+    CExpression visitLiteral(Literal* l);
+    CExpression visitIdentifier(Identifier* id);
+    CExpression visitFunctionCall(FunctionCall* f);
+    CExpression visitIfStatement(IfStatement* iff);
+    CExpression visitWhileLoop(WhileLoop* w);
+    CExpression visitForLoop(ForLoop* f);
+    CExpression visitReturnStatement(ReturnStatement* r);
+
+private:
+    struct Variable {
+        std::string name;  // C identifier
+        ValueType type;
+        size_t order;      // Declaration order, for a stable output
+    };
+
+    std::ostringstream body;
+    std::unordered_map<std::string_view, Variable> variables;
+    int indent = 1;
+
+    void line(const std::string& text);
+    void compileBlock(const ASTNodeList& statements);
+    std::string condition(ASTNodePtr node);
+    std::string convert(const CExpression& value, ValueType to);
+    const Variable& variableFor(std::string_view name) const;
+};
+
+#endif // C_GENERATOR_H
@@ -0,0 +1,148 @@
+#ifndef COMPILE_CACHE_H
+#define COMPILE_CACHE_H
+
+#include "source_buffer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 64-bit hash of `data`, eight bytes per step. Fast, well mixed and stable
+// across runs, but not cryptographic.
+uint64_t hashBytes(std::string_view data, uint64_t seed = 0);
+
+// Memory the server and batch caches may use unless --cache-size says
+// otherwise (64 MiB)
+constexpr size_t DEFAULT_CACHE_BYTES = size_t(64) << 20;
+
+// Bounded least-recently-used cache of compile results, keyed by the source
+// text and an `options` word (emit sections, -O, ...) covering everything
+// else that changes the result. Entries are found by hashBytes() of the
+// source and confirmed by comparing the stored source, so a hash collision
+// is just a miss.
+//
+// The bound is in bytes: an entry costs its source, the size of its value
+// as reported by the caller, and a fixed overhead. Inserting evicts least
+// recently used entries until the new one fits; one larger than the whole
+// budget is not kept, and a budget of 0 disables the cache. All members
+// are thread-safe. The mutex only guards the list and index: hashing,
+// copying the source in, comparing it and copying the value out happen
+// outside it, on an immutable shared record.
+template <typename Value>
+class CompileCache {
+public:
+    explicit CompileCache(size_t maxBytes) : maxBytes(maxBytes) {}
+
+    std::optional<Value> find(std::string_view source, unsigned options) {
+        uint64_t hash = hashBytes(source, options);
+        std::shared_ptr<const Record> record;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = index.find(hash);
+            if (it != index.end()) {
+                entries.splice(entries.begin(), entries, it->second);
+                record = it->second->record;
+            }
+        }
+        if (!record || record->options != options || record->source != source) {
+            ++misses;
+            return std::nullopt;
+        }
+        ++hits;
+        return record->value;
+    }
+
+    // `valueBytes` is the memory held by `value`
+    void insert(std::string_view source, unsigned options, Value value, size_t valueBytes) {
+        size_t cost = source.size() + valueBytes + ENTRY_OVERHEAD;
+        if (cost > maxBytes) return;
+        uint64_t hash = hashBytes(source, options);
+        auto record = std::make_shared<const Record>(Record{std::string(source), options, std::move(value)});
+
+        std::vector<std::shared_ptr<const Record>> evicted;  // Freed once the lock is released
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(hash);
+        if (it != index.end()) {
+            // Same source raced in from another thread, or a collision;
+            // either way the newer result replaces the entry
+            evicted.push_back(erase(it->second));
+        }
+        while (bytes + cost > maxBytes) evicted.push_back(erase(std::prev(entries.end())));
+        entries.push_front({hash, std::move(record), cost});
+        index[hash] = entries.begin();
+        bytes += cost;
+    }
+
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
+    size_t size() const { std::lock_guard<std::mutex> lock(mutex); return entries.size(); }
+    size_t getBytes() const { std::lock_guard<std::mutex> lock(mutex); return bytes; }
+    size_t getMaxBytes() const { return maxBytes; }
+
+private:
+    // Never modified once inserted, so readers can use it without the lock
+    struct Record {
+        std::string source;
+        unsigned options;
+        Value value;
+    };
+
+    struct Entry {
+        uint64_t hash;
+        std::shared_ptr<const Record> record;
+        size_t cost;
+    };
+
+    // The record, list and index nodes of one entry, roughly
+    static constexpr size_t ENTRY_OVERHEAD = sizeof(Entry) + sizeof(Record) + 96;
+
+    const size_t maxBytes;
+    mutable std::mutex mutex;
+    std::list<Entry> entries;  // Most recently used first
+    std::unordered_map<uint64_t, typename std::list<Entry>::iterator> index;
+    size_t bytes = 0;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+
+    std::shared_ptr<const Record> erase(typename std::list<Entry>::iterator entry) {
+        std::shared_ptr<const Record> record = std::move(entry->record);
+        bytes -= entry->cost;
+        index.erase(entry->hash);
+        entries.erase(entry);
+        return record;
+    }
+};
+
+// Compile results stored as files in a directory (`--cache-dir`), so they
+// survive the process and can be shared by several at once. A source maps
+// to a file named by two 64-bit hashes of its bytes, both seeded with
+// `salt`; changing the salt (a different compiler build) orphans every
+// earlier entry. Entries are written to a temporary file and
+// renamed into place, so a reader never sees a partial one. Nothing is
+// ever deleted; removing the directory clears the cache. Thread-safe.
+class DiskCache {
+public:
+    // Creates `directory` if needed; throws std::runtime_error if it cannot
+    DiskCache(const std::string& directory, std::string_view salt);
+
+    // Memory-mapped contents stored for `source`, or nullptr
+    std::shared_ptr<const SourceBuffer> find(std::string_view source);
+    // Best effort: a cache that cannot be written only costs a recompile
+    void insert(std::string_view source, std::string_view contents);
+
+private:
+    std::string directory;
+    uint64_t seed;
+
+    std::string entryPath(std::string_view source) const;
+};
+
+#endif // COMPILE_CACHE_H
@@ -0,0 +1,59 @@
+#ifndef CONSTANT_FOLDER_H
+#define CONSTANT_FOLDER_H
+
+#include "ast_arena.h"
+#include "ast_node.h"
+#include "bytecode.h"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Truthiness of a literal node as the VM sees it; nullopt for anything else
+std::optional<bool> literalTruth(ASTNodePtr node);
+
+// AST pass that evaluates operators whose operands are all literals and
+// applies algebraic identities (x + 0, x * 1, !!b, ...), rewriting the tree
+// in place. Folding follows the VM's semantics exactly: core arithmetic
+// wraps, core / core stays a core, and anything that would fail at run time
+// (division by zero, type errors) or produce a non-finite flux is left for
+// the backend to report. Identities are applied only where the static type
+// shows they cannot change the result's type or value.
+//
+// Replacement literals are allocated in `arena`, which must be the arena
+// that owns the tree (Parser::getArena()).
+class ConstantFolder : public ASTVisitor<ConstantFolder, ASTNodePtr> {
+public:
+    explicit ConstantFolder(AstArena& arena) : arena(arena) {}
+
+    void run(ASTNodePtr program);
+    size_t getFolded() const { return folded; }          // Operators replaced by a literal
+    size_t getSimplified() const { return simplified; }  // Identities applied
+
+    // Each visit returns the node that replaces its argument
+    ASTNodePtr visitNode(ASTNodePtr node) { return node; }
+    ASTNodePtr visitProgram(Program* p);
+    ASTNodePtr visitDeclaration(Declaration* d);
+    ASTNodePtr visitAssignment(Assignment* a);
+    ASTNodePtr visitBinaryOp(BinaryOp* b);
+    ASTNodePtr visitUnaryOp(UnaryOp* u);
+    ASTNodePtr visitFunctionCall(FunctionCall* f);
+    ASTNodePtr visitIfStatement(IfStatement* iff);
+    ASTNodePtr visitWhileLoop(WhileLoop* w);
+    ASTNodePtr visitForLoop(ForLoop* f);
+    ASTNodePtr visitReturnStatement(ReturnStatement* r);
+
+private:
+    AstArena& arena;
+    std::unordered_map<std::string_view, ValueType> variables;  // Declared types
+    size_t folded = 0;
+    size_t simplified = 0;
+
+    ASTNodePtr fold(ASTNodePtr node) { return node ? visit(node) : nullptr; }
+    void foldBlock(ASTNodeList& statements);
+    std::optional<ValueType> typeOf(ASTNodePtr node) const;
+    ASTNodePtr simplify(BinaryOp* b);
+    Literal* makeLiteral(const std::string& value, const char* dataType);
+};
+
+#endif // CONSTANT_FOLDER_H
@@ -0,0 +1,55 @@
+#ifndef DEAD_CODE_H
+#define DEAD_CODE_H
+
+#include "ast_node.h"
+#include "bytecode.h"
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// AST pass that removes code which can never run or whose effect is never
+// observed, rewriting the tree in place:
+//   - probe with a literal condition is replaced by the branch it takes;
+//     pulse and cycle with a falsy literal condition are dropped (a cycle
+//     keeps its initialization)
+//   - statements after a return in the same block are dropped
+//   - shards declared in removed code stay declared (the symbol table is
+//     flat): their declarations move, without initializers, to the program's
+//     declarations, where they hold the zero value the VM starts them with
+//   - shards that are never read lose their declaration and every
+//     assignment to them, provided none of those writes can fail at run
+//     time (an error must still surface) and the shard is never listened to
+//
+// Run it after ConstantFolder so folded conditions are literals.
+class DeadCodeEliminator {
+public:
+    void run(ASTNodePtr program);
+    size_t getBranches() const { return branches; }        // Constant branches and loops pruned
+    size_t getUnreachable() const { return unreachable; }  // Statements after a return
+    size_t getVariables() const { return removedVariables; }
+    const std::vector<std::string_view>& getRemovedNames() const { return removedNames; }
+
+private:
+    std::unordered_map<std::string_view, ValueType> variables;  // Declared types
+    std::vector<Declaration*> hoisted;  // Declarations rescued from removed code
+    size_t branches = 0;
+    size_t unreachable = 0;
+    size_t removedVariables = 0;
+    std::vector<std::string_view> removedNames;
+
+    void pruneBlock(ASTNodeList& statements);
+    void drop(ASTNodePtr node);
+    bool removeDeadVariables(Program* program);
+    void removeWrites(ASTNodeList& statements, const std::unordered_set<std::string_view>& dead);
+    bool safeStore(ASTNodePtr expression, ValueType target) const;
+};
+
+// Type of an expression that cannot fail at run time, given the declared
+// types of the variables it reads; nullopt if it might (type errors,
+// core / 0, ...) or its type is not evident
+std::optional<ValueType> safeType(ASTNodePtr expression,
+                                  const std::unordered_map<std::string_view, ValueType>& variables);
+
+#endif // DEAD_CODE_H
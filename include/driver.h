@@ -0,0 +1,44 @@
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include "parser.h"
+#include "optimizer.h"
+#include "json_writer.h"
+#include <string>
+#include <vector>
+#include <memory>
+
+// Sections of the `--json` result, selected with --emit=errors,symbols,tokens,ast.
+// "hasErrors" and "errorCount" are always written.
+enum EmitSection : unsigned {
+    EMIT_ERRORS = 1u << 0,
+    EMIT_SYMBOLS = 1u << 1,
+    EMIT_TOKENS = 1u << 2,
+    EMIT_AST = 1u << 3,
+    EMIT_ALL = EMIT_ERRORS | EMIT_SYMBOLS | EMIT_TOKENS | EMIT_AST
+};
+
+// Parse a comma-separated list of section names into EmitSection bits;
+// throws std::runtime_error on an unknown name
+unsigned parseEmitSections(const std::string& list);
+
+// JSON output shared by the CLI, server and batch drivers. Each helper
+// streams one value at the writer's current position.
+void writeAst(JsonWriter& json, ASTNodePtr node);
+void writeErrors(JsonWriter& json, const std::vector<std::shared_ptr<Error>>& errors);
+void writeTokens(JsonWriter& json, const std::vector<Token>& tokens);
+void writeSymbolTable(JsonWriter& json, const SymbolTable& table);
+void writeOptimizerStats(JsonWriter& json, const OptimizerStats& stats);
+
+// Scan and parse a source buffer and write the members of the
+// `compiler <file> --json` object into the object open in `json`; returns
+// whether the source had errors. Only the sections in `emit` are written,
+// and the token stream is not even kept unless it is requested. With
+// `optimizeAst` (`-O`) an error-free AST is optimized before it is
+// written, the symbol table drops the shards it removed, and an
+// "optimizer" object reports what was removed; without the ast or symbols
+// section the optimizer does not run.
+bool writeCompileResult(JsonWriter& json, std::shared_ptr<const SourceBuffer> source, bool optimizeAst = false,
+                        unsigned emit = EMIT_ALL);
+
+#endif // DRIVER_H
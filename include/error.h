@@ -7,7 +7,8 @@
 enum class ErrorType {
     SCANNER,    // Lexical error
     PARSER,     // Syntax error
-    SEMANTIC    // Semantic error
+    SEMANTIC,   // Semantic error
+    RUNTIME     // Error raised while executing a program
 };
 
 struct Error {
@@ -25,6 +26,7 @@ struct Error {
             case ErrorType::SCANNER: return "SCANNER";
             case ErrorType::PARSER: return "PARSER";
             case ErrorType::SEMANTIC: return "SEMANTIC";
+            case ErrorType::RUNTIME: return "RUNTIME";
             default: return "UNKNOWN";
         }
     }
@@ -0,0 +1,38 @@
+#ifndef INT_ARITH_H
+#define INT_ARITH_H
+
+#include <cstdint>
+
+// 59LANG integer semantics, shared by the VM and the constant folder so a
+// folded expression always matches what the program would compute.
+// Arithmetic wraps on overflow instead of being undefined.
+
+inline int64_t wrapAdd(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b)); }
+inline int64_t wrapSub(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b)); }
+inline int64_t wrapMul(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b)); }
+
+// Divisor must be non-zero; INT64_MIN / -1 wraps instead of trapping
+inline int64_t wrapDiv(int64_t a, int64_t b) { return b == -1 ? wrapSub(0, a) : a / b; }
+inline int64_t wrapMod(int64_t a, int64_t b) { return b == -1 ? 0 : a % b; }
+
+// Whether flux -> core can convert `value`: it must truncate to a value in
+// range (false for inf and nan, which compare false)
+inline bool fitsInt64(double value) { return value >= -0x1p63 && value < 0x1p63; }
+
+// int ** int stays an int: a negative exponent truncates 1 / base**-exponent
+// toward zero. A zero base needs a non-negative exponent.
+inline int64_t intPow(int64_t base, int64_t exponent) {
+    if (exponent < 0) {
+        if (base == 1 || base == -1) return (base == -1 && (exponent & 1)) ? -1 : 1;
+        return 0;
+    }
+    int64_t result = 1;
+    while (exponent > 0) {
+        if (exponent & 1) result = wrapMul(result, base);
+        base = wrapMul(base, base);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+#endif // INT_ARITH_H
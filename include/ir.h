@@ -0,0 +1,88 @@
+#ifndef IR_H
+#define IR_H
+
+#include "bytecode.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// SSA intermediate representation: a control-flow graph of basic blocks
+// whose instructions define at most one value each. Every value has a
+// static type and conversions are explicit. There are no variables; each
+// assignment defines a new value, and phis at the start of a block merge
+// the values that reach it from its predecessors.
+enum class IROp : uint8_t {
+    Const,                           // constant
+    Phi,                             // operands[i] flows in from block->predecessors[i]
+    Add, Sub, Mul, Div, Mod, Pow,    // core Div, Mod and Pow can fail at run time
+    Neg, Not,
+    Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual,
+    ToFloat,                         // core -> flux
+    ToInt,                           // flux -> core, truncating (fails outside the int range)
+    ToBool,                          // truthiness
+    ToString,                        // broadcast text of any value
+    Concat,                          // glyph + glyph
+    Read,                            // listen: one line of input as `type`
+    Print,                           // broadcast operands[0]
+
+    // Terminators: exactly one, last in every block
+    Jump,                            // to successors[0]
+    Branch,                          // operands[0] ? successors[0] : successors[1]
+    Return
+};
+
+const char* irOpToString(IROp op);
+
+struct BasicBlock;
+
+struct IRInstruction {
+    IROp op;
+    ValueType type;                        // Type of the defined value (Int if none)
+    std::vector<IRInstruction*> operands;
+    Value constant;                        // Const
+    std::string_view variable;             // Phi/Read: the variable it stands for
+    BasicBlock* block = nullptr;
+    IRInstruction* replacement = nullptr;  // Set when a trivial phi is removed
+    int id = -1;                           // Value number (%id) once numbered
+
+    IRInstruction(IROp o, ValueType t) : op(o), type(t) {}
+    bool definesValue() const;
+    bool isTerminator() const { return op == IROp::Jump || op == IROp::Branch || op == IROp::Return; }
+};
+
+struct BasicBlock {
+    int id;
+    std::vector<IRInstruction*> instructions;  // Phis first, terminator last
+    std::vector<BasicBlock*> predecessors;
+    std::vector<BasicBlock*> successors;
+    bool sealed = false;                       // All predecessors known
+
+    explicit BasicBlock(int n) : id(n) {}
+    IRInstruction* terminator() const;
+};
+
+// The whole program as one function; blocks[0] is the entry. Movable but
+// not copyable (instructions point at each other and into `strings`).
+struct IRProgram {
+    std::vector<std::unique_ptr<BasicBlock>> blocks;
+    std::deque<IRInstruction> instructions;  // Backing store, never shrinks
+    std::deque<std::string> strings;         // Backing store for glyph constants
+
+    IRProgram() = default;
+    IRProgram(IRProgram&&) = default;
+    IRProgram& operator=(IRProgram&&) = default;
+    IRProgram(const IRProgram&) = delete;
+    IRProgram& operator=(const IRProgram&) = delete;
+
+    BasicBlock* newBlock();
+    IRInstruction* newInstruction(IROp op, ValueType type);
+};
+
+// Textual listing: one block per paragraph, `%n = op type operands`
+void dumpIR(const IRProgram& program, std::ostream& out);
+
+#endif // IR_H
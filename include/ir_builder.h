@@ -0,0 +1,73 @@
+#ifndef IR_BUILDER_H
+#define IR_BUILDER_H
+
+#include "ast_node.h"
+#include "ir.h"
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Lowers a parsed Program into SSA form in a single pass over the AST,
+// following Braun et al., "Simple and Efficient Construction of Static
+// Single Assignment Form" (CC 2013): each block records the current value
+// of every variable it assigns, reads look through predecessors on demand,
+// and loop headers hold incomplete phis until their back edge is added and
+// the block is sealed. Phis that merge a single value are removed.
+//
+// Expression types are the TypeChecker's annotations (checkedType()), so the
+// AST must be checked and free of errors; unsupported input throws
+// std::runtime_error.
+class IRBuilder : public ASTVisitor<IRBuilder, IRInstruction*> {
+public:
+    IRProgram build(ASTNodePtr program);
+
+    // Expressions return their value; statements return nullptr
+    IRInstruction* visitNode(ASTNodePtr node);
+    IRInstruction* visitProgram(Program* p);
+    IRInstruction* visitDeclaration(Declaration* d);
+    IRInstruction* visitAssignment(Assignment* a);
+    IRInstruction* visitBinaryOp(BinaryOp* b);
+    IRInstruction* visitUnaryOp(UnaryOp* u);
+    IRInstruction* visitLiteral(Literal* l);
+    IRInstruction* visitIdentifier(Identifier* id);
+    IRInstruction* visitFunctionCall(FunctionCall* f);
+    IRInstruction* visitIfStatement(IfStatement* iff);
+    IRInstruction* visitWhileLoop(WhileLoop* w);
+    IRInstruction* visitForLoop(ForLoop* f);
+    IRInstruction* visitReturnStatement(ReturnStatement* r);
+
+private:
+    using Definitions = std::unordered_map<std::string_view, IRInstruction*>;
+
+    IRProgram ir;
+    BasicBlock* current = nullptr;  // nullptr after a return: what follows is unreachable
+    std::unordered_map<std::string_view, ValueType> variables;  // Declared types
+    std::vector<Definitions> definitions;                        // Per block id
+    std::vector<std::vector<std::pair<std::string_view, IRInstruction*>>> incompletePhis;
+
+    BasicBlock* newBlock();
+    IRInstruction* emit(IROp op, ValueType type, std::vector<IRInstruction*> operands = {});
+    IRInstruction* constant(Value value);
+    IRInstruction* zero(ValueType type);
+    void addEdge(BasicBlock* from, BasicBlock* to);
+    void jump(BasicBlock* target);
+    void branch(IRInstruction* condition, BasicBlock* whenTrue, BasicBlock* whenFalse);
+    void lowerBlock(const ASTNodeList& statements);
+    IRInstruction* toBool(IRInstruction* value);
+    IRInstruction* toFloat(IRInstruction* value);
+    IRInstruction* convert(IRInstruction* value, ValueType to);
+    ValueType typeOf(std::string_view name) const;
+
+    // SSA construction
+    void writeVariable(std::string_view name, BasicBlock* block, IRInstruction* value);
+    IRInstruction* readVariable(std::string_view name, BasicBlock* block);
+    IRInstruction* readVariableRecursive(std::string_view name, BasicBlock* block);
+    IRInstruction* newPhi(std::string_view name, BasicBlock* block);
+    IRInstruction* addPhiOperands(std::string_view name, IRInstruction* phi);
+    IRInstruction* tryRemoveTrivialPhi(IRInstruction* phi);
+    void sealBlock(BasicBlock* block);
+    void finish();
+};
+
+#endif // IR_BUILDER_H
@@ -0,0 +1,72 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <json/json.h>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Streaming JSON emitter. Values are written as they are produced, so a
+// large AST or token stream is never held as a Json::Value tree; output is
+// collected in a fixed-size buffer and handed to the stream in large
+// chunks.
+//
+// Compact output (no whitespace) by default; `pretty` indents nested
+// values by two spaces, one member or element per line. Inside an object
+// every value must be preceded by key(). Strings are escaped as JSON
+// requires; bytes that are not valid UTF-8 become U+FFFD.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::ostream& out, bool pretty = false);
+    ~JsonWriter() { flush(); }
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view s);
+    JsonWriter& value(const char* s) { return value(std::string_view(s)); }
+    JsonWriter& value(const std::string& s) { return value(std::string_view(s)); }
+    JsonWriter& value(bool b);
+    JsonWriter& value(int n) { return value(static_cast<int64_t>(n)); }
+    JsonWriter& value(int64_t n);
+    JsonWriter& value(uint64_t n);
+    JsonWriter& value(double d);  // Non-finite values are written as null
+    JsonWriter& value(const Json::Value& v);
+    JsonWriter& null();
+
+    // Splice members that were serialized earlier by a compact writer
+    // (`"a":1,"b":2`, no braces) into the open object
+    JsonWriter& members(std::string_view serialized);
+
+    // Hand everything written so far to the stream
+    void flush();
+
+private:
+    struct Scope {
+        bool isObject;
+        bool empty = true;
+    };
+
+    std::ostream& out;
+    bool pretty;
+    std::string buffer;
+    std::vector<Scope> scopes;
+    bool afterKey = false;  // The next value completes a member
+
+    void beginValue();
+    void endScope(char close);
+    void newline();
+    void writeString(std::string_view s);
+    void append(std::string_view s);
+    void append(char c);
+};
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,56 @@
+#ifndef LOOP_INVARIANT_H
+#define LOOP_INVARIANT_H
+
+#include "ast_arena.h"
+#include "ast_node.h"
+#include "bytecode.h"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// AST pass that moves loop-invariant expressions out of pulse and cycle
+// loops. An operator expression inside a loop (its condition, body or
+// increment) is invariant when no variable it reads is written anywhere in
+// the loop: not assigned, re-declared or listened to. Each maximal
+// invariant expression is computed once into a fresh shard declared just
+// before the loop and replaced by a read of that shard; repeats of the same
+// expression in one loop share it.
+//
+// A hoisted expression runs even when the loop body never does, so only
+// expressions that cannot fail at run time move (no type errors, no core
+// division unless the divisor is a nonzero constant; see safeType). Inner
+// loops are handled first, so an expression invariant in several nested
+// loops climbs out of all of them.
+class LoopInvariantMotion {
+public:
+    explicit LoopInvariantMotion(AstArena& a) : arena(a) {}
+
+    void run(ASTNodePtr program);
+    size_t getHoisted() const { return hoisted; }
+
+private:
+    using Names = std::unordered_set<std::string_view>;
+
+    // State for the loop being processed
+    struct Loop {
+        Names written;
+        std::vector<Declaration*> temporaries;
+        std::unordered_map<std::string, std::string_view> byExpression;  // expressionKey -> temporary
+    };
+
+    AstArena& arena;
+    std::unordered_map<std::string_view, ValueType> variables;  // Declared types, temporaries included
+    size_t nextTemporary = 0;
+    size_t hoisted = 0;
+
+    void processBlock(ASTNodeList& statements);
+    void hoistFromStatement(ASTNodePtr stmt, Loop& loop);
+    void hoistFromBlock(ASTNodeList& statements, Loop& loop);
+    ASTNodePtr hoist(ASTNodePtr expression, Loop& loop);
+    bool isInvariant(ASTNodePtr expression, const Names& written) const;
+    std::string_view newTemporary();
+};
+
+#endif // LOOP_INVARIANT_H
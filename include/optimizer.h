@@ -0,0 +1,35 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "ast_arena.h"
+#include "ast_node.h"
+#include "symbol_table.h"
+#include <cstddef>
+#include <ostream>
+
+// What one optimize() run did to the tree
+struct OptimizerStats {
+    size_t nodesBefore = 0;
+    size_t nodesAfter = 0;
+    size_t folded = 0;      // Constant operators replaced by a literal
+    size_t simplified = 0;  // Algebraic identities applied
+    size_t branches = 0;     // Constant probe/pulse/cycle statements pruned
+    size_t unreachable = 0;  // Statements after a return removed
+    size_t variables = 0;    // Unused shards removed
+    size_t hoisted = 0;      // Loop-invariant expressions moved out of loops
+
+    // Hoisting adds a declaration per temporary, so the tree can grow
+    size_t eliminated() const { return nodesBefore > nodesAfter ? nodesBefore - nodesAfter : 0; }
+    void writeReport(std::ostream& report) const;
+};
+
+// Number of nodes in the tree rooted at `node`
+size_t countNodes(ASTNodePtr node);
+
+// Run the AST optimization passes (`-O`) over an error-free program,
+// rewriting it in place. New nodes are allocated in `arena`, which must own
+// the tree (Parser::getArena()). Shards removed as unused are also removed
+// from `symbols`, if given, so the table keeps describing the tree.
+OptimizerStats optimize(ASTNodePtr program, AstArena& arena, SymbolTable* symbols = nullptr);
+
+#endif // OPTIMIZER_H
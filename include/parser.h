@@ -4,28 +4,54 @@
 #include "scanner.h"
 #include "symbol_table.h"
 #include "ast_node.h"
+#include "ast_arena.h"
 #include "error.h"
+#include <initializer_list>
 #include <vector>
 #include <memory>
 
 class Parser {
 private:
+    // Tokens are pulled from the scanner on demand into a small ring buffer,
+    // so parsing needs O(lookahead) token memory regardless of input size.
+    // The ring holds the previous token, the current one and MAX_LOOKAHEAD more.
+    static constexpr size_t TOKEN_RING_SIZE = 8;
+    static constexpr size_t MAX_LOOKAHEAD = TOKEN_RING_SIZE - 2;
+    
     Scanner scanner;
+    Token ring[TOKEN_RING_SIZE];
+    size_t current;       // Absolute index of the current token
+    size_t fetched;       // Number of tokens pulled from the scanner so far
+    bool reachedEnd;      // The scanner has produced END_OF_FILE
+    bool recordTokens;    // Also keep the full stream in `tokens` (for JSON output)
     std::vector<Token> tokens;
-    size_t current;
     std::vector<std::shared_ptr<Error>> errors;
     SymbolTable symbolTable;
+    AstArena arena;  // Owns every node returned by parse(); nodes view token text in `scanner`
     
-    // Utility methods
-    Token peek() const;
-    Token peekAhead(int distance) const;
-    Token advance();
+    // Token cursor. Returned references point into the ring and stay valid
+    // until MAX_LOOKAHEAD further tokens have been fetched; copy a Token
+    // (cheap: its value is a view) to keep it across a sub-parse.
+    void fetchToken();
+    const Token& peek();
+    const Token& peekAhead(int distance);
+    const Token& previous() const;
+    const Token& advance();
     bool match(TokenType type);
-    bool match(const std::vector<TokenType>& types);
-    bool check(TokenType type) const;
-    void consume(TokenType type, const std::string& message);
+    bool match(std::initializer_list<TokenType> types);
+    bool check(TokenType type);
+    void consume(TokenType type, const char* message);
     void error(const std::string& message, int line, int column, ErrorType type);
     
+    // Allocate a node positioned at `at`, for diagnostics from later passes
+    template <typename T>
+    T* makeNode(const Token& at) {
+        T* node = arena.make<T>();
+        node->line = at.line;
+        node->column = at.column;
+        return node;
+    }
+    
     // Parsing methods (recursive descent)
     ASTNodePtr parseProgram();
     ASTNodeList parseDeclarations();
@@ -49,15 +75,19 @@ private:
     ASTNodePtr parseFunctionCall();
     
     // Semantic analysis
-    void validateIdentifier(const std::string& name, int line, int column);
-    void declareIdentifier(const std::string& name, const std::string& type, int line, int column);
+    void validateIdentifier(std::string_view name, int line, int column);
+    void declareIdentifier(std::string_view name, const std::string& type, int line, int column);
     
 public:
-    Parser(const std::string& source);
+    // Pass recordTokens = false when getTokens() is not needed
+    Parser(const std::string& source, bool recordTokens = true);
+    Parser(std::shared_ptr<const SourceBuffer> source, bool recordTokens = true);
     ASTNodePtr parse();
-    std::vector<std::shared_ptr<Error>> getErrors() const { return errors; }
-    SymbolTable getSymbolTable() const { return symbolTable; }
-    std::vector<Token> getTokens() const { return tokens; }
+    const std::vector<std::shared_ptr<Error>>& getErrors() const { return errors; }
+    const SymbolTable& getSymbolTable() const { return symbolTable; }
+    SymbolTable& getSymbolTable() { return symbolTable; }  // For passes that remove declarations
+    const std::vector<Token>& getTokens() const { return tokens; }
+    AstArena& getArena() { return arena; }  // For passes that add nodes to the tree
     bool hasErrors() const { return !errors.empty(); }
 };
 
@@ -3,21 +3,23 @@
 
 #include "token.h"
 #include "error.h"
+#include "source_buffer.h"
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
+#include <deque>
 #include <memory>
 
 class Scanner {
 private:
-    std::string source;
+    std::shared_ptr<const SourceBuffer> buffer;  // Keeps the text behind `source` alive
+    std::string_view source;
+    std::deque<std::string> materializedStrings;  // Unescaped string literals referenced by tokens
     size_t position;
     int line;
     int column;
     std::vector<std::shared_ptr<Error>> errors;
-    std::unordered_map<std::string, TokenType> keywords;
     
-    void initializeKeywords();
     char currentChar();
     char peekChar(int offset = 1);
     void advance();
@@ -27,9 +29,14 @@ private:
     Token scanNumber();
     Token scanIdentifierOrKeyword();
     Token scanOperatorOrPunctuation();
+    std::string_view slice(size_t start) const;
     
 public:
     Scanner(const std::string& src);
+    Scanner(std::shared_ptr<const SourceBuffer> src);
+    // Tokens point into this scanner's buffers, so it must stay put
+    Scanner(const Scanner&) = delete;
+    Scanner& operator=(const Scanner&) = delete;
     Token nextToken();
     std::vector<std::shared_ptr<Error>> getErrors() const { return errors; }
     void reset();
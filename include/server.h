@@ -0,0 +1,23 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "compile_cache.h"
+#include <istream>
+#include <ostream>
+
+// Persistent compile server (`compiler --serve`).
+//
+// Reads newline-delimited JSON requests of the form {"id": ..., "code": "..."}
+// from `in` and writes one compact JSON response per line to `out`. Each
+// response carries the request id plus the same fields as `--json` output;
+// an optional "emit" (["errors", "symbols", "tokens", "ast"] or the same as
+// a comma-separated string) limits them like --emit=.
+//
+// Results are kept in an LRU cache of up to `cacheBytes` keyed by the
+// source and the requested sections, so resubmitting an unchanged source
+// replays the earlier response without scanning or parsing (0 disables
+// it); {"cmd": "stats"} reports its hit and miss counts.
+// The loop ends at end of input or on {"cmd": "shutdown"}.
+int runServer(std::istream& in, std::ostream& out, size_t cacheBytes = DEFAULT_CACHE_BYTES);
+
+#endif // SERVER_H
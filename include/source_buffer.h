@@ -0,0 +1,35 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Read-only source text shared by a Scanner and the tokens/AST that view it.
+//
+// Files are memory-mapped where the platform supports it, so even very large
+// inputs are tokenized straight out of the page cache without being copied.
+class SourceBuffer {
+private:
+    std::string owned;            // Used for in-memory sources and the read fallback
+    const char* mapped = nullptr; // Read-only mapping of the input file, if any
+    size_t mappedSize = 0;
+    
+    SourceBuffer() = default;
+    
+public:
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+    ~SourceBuffer();
+    
+    static std::shared_ptr<const SourceBuffer> fromString(std::string text);
+    // Returns nullptr and fills `error` if the file cannot be opened
+    static std::shared_ptr<const SourceBuffer> fromFile(const std::string& path, std::string& error);
+    
+    std::string_view view() const {
+        return mapped ? std::string_view(mapped, mappedSize) : std::string_view(owned);
+    }
+    bool isMapped() const { return mapped != nullptr; }
+};
+
+#endif // SOURCE_BUFFER_H
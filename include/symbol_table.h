@@ -27,6 +27,7 @@ public:
     bool exists(const std::string& name) const;
     std::shared_ptr<Symbol> getSymbol(const std::string& name) const;
     std::string getType(const std::string& name) const;
+    void removeSymbol(const std::string& name);
     
     const std::unordered_map<std::string, std::shared_ptr<Symbol>>& getAllSymbols() const {
         return symbols;
@@ -2,6 +2,7 @@
 #define TOKEN_H
 
 #include <string>
+#include <string_view>
 
 enum class TokenType {
     // Keywords
@@ -29,13 +30,16 @@ enum class TokenType {
     END_OF_FILE, NEWLINE, ERROR_TOKEN
 };
 
+// A token's value is a view into the scanner's source buffer (or, for string
+// literals containing escapes, into a copy held by the scanner), so tokens are
+// only valid while the Scanner that produced them is alive.
 struct Token {
     TokenType type;
-    std::string value;
+    std::string_view value;
     int line;
     int column;
     
-    Token(TokenType t = TokenType::ERROR_TOKEN, const std::string& v = "", 
+    Token(TokenType t = TokenType::ERROR_TOKEN, std::string_view v = {}, 
           int l = 0, int c = 0)
         : type(t), value(v), line(l), column(c) {}
     
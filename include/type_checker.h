@@ -0,0 +1,61 @@
+#ifndef TYPE_CHECKER_H
+#define TYPE_CHECKER_H
+
+#include "ast_node.h"
+#include "error.h"
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Static type inference over a parsed Program. Every expression node gets
+// its resolved type in ASTNode::valueType, following the runtime rules:
+//   - core op core stays core; any flux operand promotes the other to flux
+//   - glyph + anything concatenates to a glyph
+//   - comparisons, join/either and void yield sig; values of different
+//     types compare (==, !=) as never equal
+//   - stores convert core <-> flux (flux -> core truncates)
+// Operators applied to the wrong types and stores that cannot convert are
+// reported as SEMANTIC errors at the offending node. An expression whose
+// type cannot be resolved (undeclared shard, operand error) is left
+// unannotated and does not produce further errors.
+//
+// Variables take the type of their declaration; the symbol table is flat,
+// so a shard declared inside a block has that type everywhere.
+class TypeChecker : public ASTVisitor<TypeChecker, std::optional<ValueType>> {
+public:
+    // Annotate `program`, returning the type errors in source order of discovery
+    std::vector<std::shared_ptr<Error>> check(ASTNodePtr program);
+
+    // Expressions return their type; statements return nullopt
+    std::optional<ValueType> visitNode(ASTNodePtr) { return std::nullopt; }
+    std::optional<ValueType> visitProgram(Program* p);
+    std::optional<ValueType> visitDeclaration(Declaration* d);
+    std::optional<ValueType> visitAssignment(Assignment* a);
+    std::optional<ValueType> visitBinaryOp(BinaryOp* b);
+    std::optional<ValueType> visitUnaryOp(UnaryOp* u);
+    std::optional<ValueType> visitLiteral(Literal* l);
+    std::optional<ValueType> visitIdentifier(Identifier* id);
+    std::optional<ValueType> visitFunctionCall(FunctionCall* f);
+    std::optional<ValueType> visitIfStatement(IfStatement* iff);
+    std::optional<ValueType> visitWhileLoop(WhileLoop* w);
+    std::optional<ValueType> visitForLoop(ForLoop* f);
+    std::optional<ValueType> visitReturnStatement(ReturnStatement* r);
+
+private:
+    std::unordered_map<std::string_view, ValueType> variables;  // Declared types
+    std::vector<std::shared_ptr<Error>> errors;
+
+    std::optional<ValueType> typeOf(ASTNodePtr expression);
+    void checkBlock(const ASTNodeList& statements);
+    void checkStore(ASTNodePtr value, ValueType target, std::string_view name, ASTNodePtr at);
+    void error(const std::string& message, ASTNodePtr at);
+};
+
+// The type TypeChecker gave `expression`. The backends read types through
+// this rather than re-deriving them, so they only see checked programs;
+// throws std::runtime_error for an expression the checker left unannotated.
+ValueType checkedType(ASTNodePtr expression);
+
+#endif // TYPE_CHECKER_H
@@ -0,0 +1,16 @@
+#ifndef VALUE_TYPE_H
+#define VALUE_TYPE_H
+
+#include <cstdint>
+#include <string>
+
+// One tag per 59LANG type (core/flux/sig/glyph); shared by the type
+// checker's AST annotations and the runtime values of every backend
+enum class ValueType : uint8_t {
+    Int, Float, Bool, String
+};
+
+const char* valueTypeToString(ValueType type);
+ValueType valueTypeFromName(const std::string& name);  // "int"/"float"/"bool"/"string"
+
+#endif // VALUE_TYPE_H
@@ -0,0 +1,60 @@
+#ifndef VM_H
+#define VM_H
+
+#include "bytecode.h"
+#include "error.h"
+#include <deque>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Dynamic instruction counts from a profiled run
+struct VMStats {
+    std::vector<uint64_t> executed;  // Indexed by OpCode
+
+    uint64_t total() const;
+    uint64_t saved() const;  // Dispatches avoided by superinstructions
+    void writeReport(std::ostream& report) const;
+};
+
+// Stack machine executing a Chunk. `listen` reads one line from `in` per
+// call; `broadcast` writes one line to `out`.
+class VM {
+private:
+    const Chunk& chunk;
+    std::istream& in;
+    std::ostream& out;
+    std::vector<Value> stack;
+    std::vector<Value> slots;
+    std::deque<std::string> strings;  // Strings created at run time (input, concatenation)
+    std::shared_ptr<Error> error;
+    bool profiling = false;
+    VMStats stats;
+
+    bool fail(const std::string& message);
+    bool binary(OpCode op, Value& left, const Value& right);
+    bool store(int32_t slot, const Value& value);
+    bool read(int32_t slot);
+    const std::string* newString(std::string text);
+    template <bool Threaded, bool Profile> bool execute();
+
+public:
+    // How the interpreter loop finds the next handler: a `switch` on the
+    // opcode, or (GCC/Clang only) a direct jump through a table of handler
+    // addresses built when the run starts
+    enum class Dispatch { Switch, Threaded };
+    
+    VM(const Chunk& chunk, std::istream& in, std::ostream& out);
+    bool run();  // false on a runtime error; see getError()
+    bool run(Dispatch mode);  // Threaded falls back to Switch where unsupported
+    static Dispatch defaultDispatch();  // Chosen at build time (VM_THREADED_DISPATCH)
+    std::shared_ptr<Error> getError() const { return error; }
+    
+    // Count every executed instruction by opcode (slower; off by default)
+    void setProfiling(bool enabled) { profiling = enabled; }
+    const VMStats& getStats() const { return stats; }
+};
+
+#endif // VM_H
@@ -0,0 +1,216 @@
+/*
+ * Runtime support for the native backends.
+ *
+ * Link it with the output of `compiler --emit-asm`:
+ *     cc program.s runtime/runtime.c -lm -o program
+ *
+ * `compiler --emit-c` embeds this file at the top of the generated program
+ * (the build turns it into a string), so it must stay self-contained C99.
+ *
+ * Behaviour matches the bytecode VM (`compiler --run`): `listen` reads one
+ * line per call, `broadcast` prints one line, and runtime errors are
+ * reported on stderr with exit status 1.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void rt_error(const char* message) {
+    fflush(stdout);
+    fprintf(stderr, "Runtime error: %s\n", message);
+    exit(1);
+}
+
+void rt_division_by_zero(void) {
+    rt_error("Division by zero");
+}
+
+void rt_modulo_by_zero(void) {
+    rt_error("Modulo by zero");
+}
+
+static void rt_invalid_input(const char* expected, const char* text) {
+    fflush(stdout);
+    fprintf(stderr, "Runtime error: Invalid input: expected %s, got '%s'\n", expected, text);
+    exit(1);
+}
+
+/* ---- Output ---- */
+
+void rt_print_int(int64_t value) {
+    printf("%" PRId64 "\n", value);
+}
+
+void rt_print_float(double value) {
+    printf("%.15g\n", value);
+}
+
+void rt_print_bool(int64_t value) {
+    puts(value ? "true" : "false");
+}
+
+void rt_print_string(const char* value) {
+    puts(value);
+}
+
+/* ---- Input: one line per call, surrounding blanks trimmed ---- */
+
+static char* rt_read_line(void) {
+    size_t capacity = 64, length = 0;
+    char* line = malloc(capacity);
+    int c;
+
+    if (!line) rt_error("Out of memory");
+    fflush(stdout);
+    while ((c = getchar()) != EOF && c != '\n') {
+        if (length + 1 == capacity) {
+            capacity *= 2;
+            line = realloc(line, capacity);
+            if (!line) rt_error("Out of memory");
+        }
+        line[length++] = (char)c;
+    }
+    if (c == EOF && length == 0) rt_error("Unexpected end of input");
+
+    while (length > 0 && strchr(" \t\r", line[length - 1])) --length;
+    line[length] = '\0';
+
+    size_t start = strspn(line, " \t\r");
+    memmove(line, line + start, length - start + 1);
+    return line;
+}
+
+int64_t rt_read_int(void) {
+    char* text = rt_read_line();
+    char* end;
+    errno = 0;
+    long long value = strtoll(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || errno == ERANGE) rt_invalid_input("integer", text);
+    free(text);
+    return value;
+}
+
+double rt_read_float(void) {
+    char* text = rt_read_line();
+    char* end;
+    double value = strtod(text, &end);
+    if (*text == '\0' || *end != '\0') rt_invalid_input("float", text);
+    free(text);
+    return value;
+}
+
+int64_t rt_read_bool(void) {
+    char* text = rt_read_line();
+    int64_t value = 0;
+    if (strcmp(text, "true") == 0 || strcmp(text, "1") == 0) {
+        value = 1;
+    } else if (strcmp(text, "false") == 0 || strcmp(text, "0") == 0) {
+        value = 0;
+    } else {
+        rt_invalid_input("boolean (true/false)", text);
+    }
+    free(text);
+    return value;
+}
+
+const char* rt_read_string(void) {
+    return rt_read_line();  /* Strings live until the program exits */
+}
+
+/* ---- Arithmetic helpers ---- */
+
+/* Integer arithmetic wraps on overflow, as in the VM (the assembly does
+   this inline; the C backend calls these) */
+int64_t rt_add(int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+int64_t rt_sub(int64_t a, int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }
+int64_t rt_mul(int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }
+int64_t rt_neg(int64_t a) { return (int64_t)(0 - (uint64_t)a); }
+
+int64_t rt_div(int64_t a, int64_t b) {
+    if (b == 0) rt_division_by_zero();
+    return b == -1 ? rt_neg(a) : a / b;
+}
+
+int64_t rt_mod(int64_t a, int64_t b) {
+    if (b == 0) rt_modulo_by_zero();
+    return b == -1 ? 0 : a % b;
+}
+
+int64_t rt_pow_int(int64_t base, int64_t exponent) {
+    if (exponent < 0) {
+        if (base == 0) rt_division_by_zero();
+        if (base == 1) return 1;
+        if (base == -1) return (exponent & 1) ? -1 : 1;
+        return 0;
+    }
+
+    uint64_t result = 1, b = (uint64_t)base;
+    while (exponent > 0) {
+        if (exponent & 1) result *= b;
+        b *= b;
+        exponent >>= 1;
+    }
+    return (int64_t)result;
+}
+
+double rt_pow_float(double base, double exponent) {
+    return pow(base, exponent);
+}
+
+double rt_fmod(double a, double b) {
+    return fmod(a, b);
+}
+
+int64_t rt_float_to_int(double value) {
+    /* Out of range (or inf/nan, which compare false) is undefined in C */
+    if (!(value >= -0x1p63 && value < 0x1p63)) {
+        char message[64];
+        snprintf(message, sizeof(message), "Cannot convert %.15g to int", value);
+        rt_error(message);
+    }
+    return (int64_t)value;
+}
+
+/* ---- Strings ---- */
+
+static const char* rt_format(const char* format, ...) {
+    char buffer[64];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    size_t length = strlen(buffer) + 1;
+    char* copy = malloc(length);
+    if (!copy) rt_error("Out of memory");
+    return memcpy(copy, buffer, length);
+}
+
+const char* rt_int_to_string(int64_t value) {
+    return rt_format("%" PRId64, value);
+}
+
+const char* rt_float_to_string(double value) {
+    return rt_format("%.15g", value);
+}
+
+const char* rt_bool_to_string(int64_t value) {
+    return value ? "true" : "false";
+}
+
+const char* rt_concat(const char* a, const char* b) {
+    size_t la = strlen(a), lb = strlen(b);
+    char* result = malloc(la + lb + 1);
+    if (!result) rt_error("Out of memory");
+    memcpy(result, a, la);
+    memcpy(result + la, b, lb + 1);
+    return result;
+}
+
+int64_t rt_compare_strings(const char* a, const char* b) {
+    return strcmp(a, b);
+}
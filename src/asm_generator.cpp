@@ -0,0 +1,628 @@
+#include "../include/asm_generator.h"
+#include "../include/type_checker.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+static bool isNumeric(ValueType type) {
+    return type == ValueType::Int || type == ValueType::Float;
+}
+
+static bool isComparison(std::string_view op) {
+    return op == "<" || op == "<=" || op == ">" || op == ">=" || op == "==" || op == "!=";
+}
+
+// Condition-code suffix for a signed integer comparison
+static const char* conditionCode(std::string_view op) {
+    if (op == "<") return "l";
+    if (op == "<=") return "le";
+    if (op == ">") return "g";
+    if (op == ">=") return "ge";
+    if (op == "==") return "e";
+    return "ne";
+}
+
+static std::string invertCondition(const std::string& cc) {
+    if (cc == "l") return "ge";
+    if (cc == "le") return "g";
+    if (cc == "g") return "le";
+    if (cc == "ge") return "l";
+    if (cc == "e") return "ne";
+    return "e";
+}
+
+void AsmGenerator::generate(ASTNodePtr program, std::ostream& out) {
+    body.str("");
+    variables.clear();
+    strings.clear();
+    floats.clear();
+    labelCount = 0;
+    pushDepth = 0;
+
+    visit(program);
+
+    // The frame size is only known once the body has been generated
+    int32_t frameSize = static_cast<int32_t>(variables.size()) * 8;
+    frameSize = (frameSize + 15) & ~15;
+    std::string empty = stringLabel("");
+
+    out << "# Generated by the 59LANG compiler (compiler --emit-asm)\n";
+    out << "    .text\n";
+    out << "    .globl main\n";
+    out << "    .type main, @function\n";
+    out << "main:\n";
+    out << "    push %rbp\n";
+    out << "    mov %rsp, %rbp\n";
+    if (frameSize > 0) out << "    sub $" << frameSize << ", %rsp\n";
+
+    // Every variable starts as its type's zero value (0, 0.0, false, "")
+    std::vector<const Variable*> frame;
+    for (const auto& entry : variables) frame.push_back(&entry.second);
+    std::sort(frame.begin(), frame.end(), [](const Variable* a, const Variable* b) {
+        return a->offset > b->offset;
+    });
+    for (const Variable* variable : frame) {
+        const Variable& v = *variable;
+        if (v.type == ValueType::String) {
+            out << "    lea " << empty << "(%rip), %rax\n";
+            out << "    mov %rax, " << v.offset << "(%rbp)\n";
+        } else {
+            out << "    movq $0, " << v.offset << "(%rbp)\n";
+        }
+    }
+
+    out << body.str();
+    out << ".Lexit:\n";
+    out << "    xor %eax, %eax\n";
+    out << "    leave\n";
+    out << "    ret\n";
+    out << "    .size main, .-main\n";
+
+    out << "\n    .section .rodata\n";
+    for (size_t i = 0; i < strings.size(); ++i) {
+        out << ".LS" << i << ":\n    .string \"";
+        for (unsigned char c : strings[i]) {
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (c < 0x20 || c >= 0x7f) {
+                char octal[8];
+                std::snprintf(octal, sizeof(octal), "\\%03o", c);
+                out << octal;
+            } else {
+                out << c;
+            }
+        }
+        out << "\"\n";
+    }
+    if (!floats.empty()) out << "    .align 8\n";
+    for (size_t i = 0; i < floats.size(); ++i) {
+        uint64_t bits;
+        std::memcpy(&bits, &floats[i], sizeof(bits));
+        char hex[32];
+        std::snprintf(hex, sizeof(hex), "0x%016llx", static_cast<unsigned long long>(bits));
+        out << ".LF" << i << ":\n    .quad " << hex << "\n";
+    }
+    out << "    .section .note.GNU-stack,\"\",@progbits\n";
+}
+
+void AsmGenerator::emit(const std::string& instruction) {
+    body << "    " << instruction << "\n";
+}
+
+std::string AsmGenerator::newLabel() {
+    return ".L" + std::to_string(labelCount++);
+}
+
+void AsmGenerator::placeLabel(const std::string& label) {
+    body << label << ":\n";
+}
+
+std::string AsmGenerator::stringLabel(std::string_view text) {
+    for (size_t i = 0; i < strings.size(); ++i) {
+        if (strings[i] == text) return ".LS" + std::to_string(i);
+    }
+    strings.emplace_back(text);
+    return ".LS" + std::to_string(strings.size() - 1);
+}
+
+std::string AsmGenerator::floatLabel(double value) {
+    floats.push_back(value);
+    return ".LF" + std::to_string(floats.size() - 1);
+}
+
+const AsmGenerator::Variable& AsmGenerator::variableFor(std::string_view name) const {
+    auto it = variables.find(name);
+    if (it == variables.end()) {
+        throw std::runtime_error("Symbol '" + std::string(name) + "' not declared");
+    }
+    return it->second;
+}
+
+// Spill the value in %rax/%xmm0 to the machine stack
+void AsmGenerator::push(ValueType type) {
+    if (type == ValueType::Float) {
+        emit("sub $8, %rsp");
+        emit("movsd %xmm0, (%rsp)");
+    } else {
+        emit("push %rax");
+    }
+    ++pushDepth;
+}
+
+// Pop a value spilled by push(type) into %rax, or into %xmm0 as a float
+void AsmGenerator::popInto(ValueType type, ValueType as) {
+    if (as == ValueType::Float && type == ValueType::Float) {
+        emit("movsd (%rsp), %xmm0");
+        emit("add $8, %rsp");
+    } else {
+        emit("pop %rax");
+        if (as == ValueType::Float) emit("cvtsi2sdq %rax, %xmm0");
+    }
+    --pushDepth;
+}
+
+// Calls must see a 16-byte aligned %rsp; the frame is aligned, so only the
+// spilled temporaries can misalign it
+void AsmGenerator::call(const char* function) {
+    if (pushDepth % 2) {
+        emit("sub $8, %rsp");
+        emit(std::string("call ") + function);
+        emit("add $8, %rsp");
+    } else {
+        emit(std::string("call ") + function);
+    }
+}
+
+// Convert the value in %rax/%xmm0 for storing into a variable of type `to`;
+// the checker only allows core <-> flux conversions
+void AsmGenerator::convert(ValueType from, ValueType to) {
+    if (from == ValueType::Int && to == ValueType::Float) {
+        emit("cvtsi2sdq %rax, %xmm0");
+    } else if (from == ValueType::Float && to == ValueType::Int) {
+        call("rt_float_to_int");
+    }
+}
+
+// Truthiness of the value in %rax/%xmm0, as 0/1 in %rax
+void AsmGenerator::toBool(ValueType type) {
+    switch (type) {
+        case ValueType::Bool:
+            return;
+        case ValueType::Int:
+            emit("test %rax, %rax");
+            emit("setne %al");
+            break;
+        case ValueType::Float:
+            emit("xorpd %xmm1, %xmm1");
+            emit("ucomisd %xmm1, %xmm0");
+            emit("setne %al");
+            emit("setp %cl");
+            emit("or %cl, %al");
+            break;
+        case ValueType::String:
+            emit("cmpb $0, (%rax)");
+            emit("setne %al");
+            break;
+    }
+    emit("movzbl %al, %eax");
+}
+
+// Text of the value in %rax/%xmm0, as a string pointer in %rax
+void AsmGenerator::toString(ValueType type) {
+    switch (type) {
+        case ValueType::String:
+            return;
+        case ValueType::Int:
+            emit("mov %rax, %rdi");
+            call("rt_int_to_string");
+            break;
+        case ValueType::Float:
+            call("rt_float_to_string");
+            break;
+        case ValueType::Bool:
+            emit("mov %rax, %rdi");
+            call("rt_bool_to_string");
+            break;
+    }
+}
+
+void AsmGenerator::store(const Variable& variable) {
+    if (variable.type == ValueType::Float) {
+        emit("movsd %xmm0, " + std::to_string(variable.offset) + "(%rbp)");
+    } else {
+        emit("mov %rax, " + std::to_string(variable.offset) + "(%rbp)");
+    }
+}
+
+void AsmGenerator::branchIfFalse(ASTNodePtr condition, const std::string& target) {
+    // An int comparison at the top of the condition can branch on the flags
+    // it sets instead of materializing a bool first
+    auto cmp = nodeAs<BinaryOp>(condition);
+    flagsRequested = cmp && isComparison(cmp->operation);
+    flagsCondition.clear();
+
+    ValueType type = visit(condition);
+    if (!flagsCondition.empty()) {
+        emit("j" + invertCondition(flagsCondition) + " " + target);
+        flagsCondition.clear();
+        return;
+    }
+
+    toBool(type);
+    emit("test %rax, %rax");
+    emit("je " + target);
+}
+
+// Int operand that can be used in place without evaluating it into a
+// register first: a variable or a 32-bit literal
+bool AsmGenerator::directIntOperand(ASTNodePtr node, std::string& operand) const {
+    if (auto id = nodeAs<Identifier>(node)) {
+        auto it = variables.find(id->name);
+        if (it == variables.end() || it->second.type != ValueType::Int) return false;
+        operand = std::to_string(it->second.offset) + "(%rbp)";
+        return true;
+    }
+    if (auto literal = nodeAs<Literal>(node); literal && literal->dataType == "int") {
+        try {
+            int64_t value = std::stoll(std::string(literal->value));
+            if (value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max()) return false;
+            operand = "$" + std::to_string(value);
+            return true;
+        } catch (const std::out_of_range&) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// %rax = %rax <op> %rcx for two ints
+ValueType AsmGenerator::intBinary(std::string_view op, bool wantFlags) {
+    if (op == "+") emit("add %rcx, %rax");
+    else if (op == "-") emit("sub %rcx, %rax");
+    else if (op == "*") emit("imul %rcx, %rax");
+    else if (op == "/") divide(false);
+    else if (op == "%") divide(true);
+    else if (op == "**") {
+        emit("mov %rax, %rdi");
+        emit("mov %rcx, %rsi");
+        call("rt_pow_int");
+    } else {
+        emit("cmp %rcx, %rax");
+        if (wantFlags) {
+            flagsCondition = conditionCode(op);
+        } else {
+            emit(std::string("set") + conditionCode(op) + " %al");
+            emit("movzbl %al, %eax");
+        }
+        return ValueType::Bool;
+    }
+    return ValueType::Int;
+}
+
+void AsmGenerator::compileBlock(const ASTNodeList& statements) {
+    for (ASTNodePtr stmt : statements) {
+        if (stmt) visit(stmt);
+    }
+}
+
+// %rax = %rax / %rcx (or % %rcx), with the VM's zero and overflow rules
+void AsmGenerator::divide(bool modulo) {
+    std::string nonZero = newLabel(), normal = newLabel(), done = newLabel();
+
+    emit("test %rcx, %rcx");
+    emit("jne " + nonZero);
+    call(modulo ? "rt_modulo_by_zero" : "rt_division_by_zero");
+    placeLabel(nonZero);
+
+    // INT64_MIN / -1 would trap in idiv; x / -1 is just -x (wrapping)
+    emit("cmp $-1, %rcx");
+    emit("jne " + normal);
+    emit(modulo ? "xor %eax, %eax" : "neg %rax");
+    emit("jmp " + done);
+
+    placeLabel(normal);
+    emit("cqo");
+    emit("idiv %rcx");
+    if (modulo) emit("mov %rdx, %rax");
+    placeLabel(done);
+}
+
+ValueType AsmGenerator::visitNode(ASTNodePtr node) {
+    throw std::runtime_error(std::string("Cannot compile ") + nodeKindToString(node->kind) + " node");
+}
+
+ValueType AsmGenerator::visitProgram(Program* p) {
+    compileBlock(p->declarations);
+    compileBlock(p->statements);
+    return ValueType::Int;
+}
+
+ValueType AsmGenerator::visitDeclaration(Declaration* d) {
+    ValueType type = valueTypeFromName(std::string(d->dataType));
+
+    for (size_t i = 0; i < d->identifiers.size(); ++i) {
+        std::string_view name = d->identifiers[i];
+        if (!variables.count(name)) {
+            int32_t offset = -8 * static_cast<int32_t>(variables.size() + 1);
+            variables.emplace(name, Variable{std::string(name), offset, type});
+        }
+        const Variable& variable = variableFor(name);
+        ASTNodePtr init = i < d->initializers.size() ? d->initializers[i] : nullptr;
+
+        // Re-running a declaration (e.g. inside a loop body) resets the variable
+        if (init) {
+            convert(visit(init), type);
+            store(variable);
+        } else if (type == ValueType::String) {
+            emit("lea " + stringLabel("") + "(%rip), %rax");
+            store(variable);
+        } else {
+            emit("movq $0, " + std::to_string(variable.offset) + "(%rbp)");
+        }
+    }
+    return ValueType::Int;
+}
+
+ValueType AsmGenerator::visitAssignment(Assignment* a) {
+    const Variable& variable = variableFor(a->identifier);
+    convert(visit(a->expression), variable.type);
+    store(variable);
+    return ValueType::Int;
+}
+
+ValueType AsmGenerator::visitBinaryOp(BinaryOp* b) {
+    std::string_view op = b->operation;
+    ValueType type = checkedType(b);
+
+    // Short-circuit operators test their operands' truthiness
+    if (op == "&&" || op == "||") {
+        std::string shortCircuit = newLabel(), end = newLabel();
+        toBool(visit(b->left));
+        emit("test %rax, %rax");
+        emit(std::string(op == "&&" ? "je " : "jne ") + shortCircuit);
+        toBool(visit(b->right));
+        emit("jmp " + end);
+        placeLabel(shortCircuit);
+        emit(op == "&&" ? "xor %eax, %eax" : "mov $1, %eax");
+        placeLabel(end);
+        return ValueType::Bool;
+    }
+
+    // Only the outermost comparison of a branch condition may leave its
+    // result in the flags
+    bool wantFlags = flagsRequested;
+    flagsRequested = false;
+
+    ValueType left = visit(b->left);
+
+    std::string operand;
+    if (left == ValueType::Int && op != "+" && directIntOperand(b->right, operand)) {
+        emit("mov " + operand + ", %rcx");
+        return intBinary(op, wantFlags);
+    }
+    if (left == ValueType::Int && op == "+" && directIntOperand(b->right, operand)) {
+        emit("add " + operand + ", %rax");
+        return ValueType::Int;
+    }
+
+    push(left);
+    ValueType right = visit(b->right);
+
+    // String concatenation: either side a string, the other is formatted
+    if (type == ValueType::String) {
+        toString(right);
+        emit("push %rax");
+        ++pushDepth;
+        emit(left == ValueType::Float ? "movsd 8(%rsp), %xmm0" : "mov 8(%rsp), %rax");
+        toString(left);
+        emit("mov %rax, %rdi");
+        emit("pop %rsi");
+        emit("add $8, %rsp");
+        pushDepth -= 2;
+        call("rt_concat");
+        return ValueType::String;
+    }
+
+    if (type == ValueType::Int) {
+        emit("mov %rax, %rcx");
+        popInto(left, ValueType::Int);
+        return intBinary(op, false);
+    }
+    if (type == ValueType::Float) {
+        if (right == ValueType::Int) emit("cvtsi2sdq %rax, %xmm0");
+        emit("movapd %xmm0, %xmm1");
+        popInto(left, ValueType::Float);
+        if (op == "+") emit("addsd %xmm1, %xmm0");
+        else if (op == "-") emit("subsd %xmm1, %xmm0");
+        else if (op == "*") emit("mulsd %xmm1, %xmm0");
+        else if (op == "/") emit("divsd %xmm1, %xmm0");
+        else if (op == "%") call("rt_fmod");
+        else call("rt_pow_float");
+        return ValueType::Float;
+    }
+
+    // Comparisons
+    bool bothInt = left == ValueType::Int && right == ValueType::Int;
+    if (bothInt || (left == ValueType::Bool && right == ValueType::Bool)) {
+        emit("mov %rax, %rcx");
+        popInto(left, ValueType::Int);
+        return intBinary(op, wantFlags);
+    } else if (isNumeric(left) && isNumeric(right)) {
+        if (right == ValueType::Int) emit("cvtsi2sdq %rax, %xmm0");
+        emit("movapd %xmm0, %xmm1");
+        popInto(left, ValueType::Float);
+
+        // Unordered (NaN) operands make every comparison but != false
+        if (op == "<" || op == "<=") {
+            emit("ucomisd %xmm0, %xmm1");
+            emit(op == "<" ? "seta %al" : "setae %al");
+        } else if (op == ">" || op == ">=") {
+            emit("ucomisd %xmm1, %xmm0");
+            emit(op == ">" ? "seta %al" : "setae %al");
+        } else if (op == "==") {
+            emit("ucomisd %xmm1, %xmm0");
+            emit("sete %al");
+            emit("setnp %cl");
+            emit("and %cl, %al");
+        } else {
+            emit("ucomisd %xmm1, %xmm0");
+            emit("setne %al");
+            emit("setp %cl");
+            emit("or %cl, %al");
+        }
+    } else if (left == ValueType::String && right == ValueType::String) {
+        emit("mov %rax, %rsi");
+        popInto(left, ValueType::String);
+        emit("mov %rax, %rdi");
+        call("rt_compare_strings");
+        emit("cmp $0, %rax");
+        emit(std::string("set") + conditionCode(op) + " %al");
+    } else {
+        // Values of different types are never equal
+        emit("add $8, %rsp");
+        --pushDepth;
+        emit(op == "!=" ? "mov $1, %eax" : "xor %eax, %eax");
+        return ValueType::Bool;
+    }
+
+    emit("movzbl %al, %eax");
+    return ValueType::Bool;
+}
+
+ValueType AsmGenerator::visitUnaryOp(UnaryOp* u) {
+    ValueType type = visit(u->operand);
+
+    if (u->operation == "!") {
+        toBool(type);
+        emit("xor $1, %eax");
+        return ValueType::Bool;
+    }
+
+    if (type == ValueType::Int) {
+        emit("neg %rax");
+    } else {
+        emit("movq %xmm0, %rax");
+        emit("btc $63, %rax");
+        emit("movq %rax, %xmm0");
+    }
+    return type;
+}
+
+ValueType AsmGenerator::visitLiteral(Literal* l) {
+    if (l->dataType == "int") {
+        int64_t value;
+        try {
+            value = std::stoll(std::string(l->value));
+        } catch (const std::out_of_range&) {
+            throw std::runtime_error("Integer literal '" + std::string(l->value) + "' out of range");
+        }
+        bool fits32 = value >= std::numeric_limits<int32_t>::min() && value <= std::numeric_limits<int32_t>::max();
+        emit(std::string(fits32 ? "mov $" : "movabs $") + std::to_string(value) + ", %rax");
+        return ValueType::Int;
+    }
+    if (l->dataType == "float") {
+        emit("movsd " + floatLabel(std::stod(std::string(l->value))) + "(%rip), %xmm0");
+        return ValueType::Float;
+    }
+    if (l->dataType == "bool") {
+        emit(l->value == "true" ? "mov $1, %eax" : "xor %eax, %eax");
+        return ValueType::Bool;
+    }
+
+    emit("lea " + stringLabel(l->value) + "(%rip), %rax");
+    return ValueType::String;
+}
+
+ValueType AsmGenerator::visitIdentifier(Identifier* id) {
+    const Variable& variable = variableFor(id->name);
+    std::string slot = std::to_string(variable.offset) + "(%rbp)";
+    emit(variable.type == ValueType::Float ? "movsd " + slot + ", %xmm0" : "mov " + slot + ", %rax");
+    return variable.type;
+}
+
+ValueType AsmGenerator::visitFunctionCall(FunctionCall* f) {
+    if (f->functionName == "input") {
+        auto target = nodeAs<Identifier>(f->arguments.empty() ? nullptr : f->arguments[0]);
+        if (!target) throw std::runtime_error("listen expects a variable");
+
+        const Variable& variable = variableFor(target->name);
+        switch (variable.type) {
+            case ValueType::Int: call("rt_read_int"); break;
+            case ValueType::Float: call("rt_read_float"); break;
+            case ValueType::Bool: call("rt_read_bool"); break;
+            case ValueType::String: call("rt_read_string"); break;
+        }
+        store(variable);
+        return ValueType::Int;
+    }
+
+    ValueType type = visit(f->arguments.at(0));
+    switch (type) {
+        case ValueType::Int:
+            emit("mov %rax, %rdi");
+            call("rt_print_int");
+            break;
+        case ValueType::Float:
+            call("rt_print_float");
+            break;
+        case ValueType::Bool:
+            emit("mov %rax, %rdi");
+            call("rt_print_bool");
+            break;
+        case ValueType::String:
+            emit("mov %rax, %rdi");
+            call("rt_print_string");
+            break;
+    }
+    return ValueType::Int;
+}
+
+ValueType AsmGenerator::visitIfStatement(IfStatement* iff) {
+    std::string elseLabel = newLabel();
+    branchIfFalse(iff->condition, elseLabel);
+    compileBlock(iff->thenBranch);
+
+    if (iff->elseBranch.empty()) {
+        placeLabel(elseLabel);
+        return ValueType::Int;
+    }
+
+    std::string end = newLabel();
+    emit("jmp " + end);
+    placeLabel(elseLabel);
+    compileBlock(iff->elseBranch);
+    placeLabel(end);
+    return ValueType::Int;
+}
+
+ValueType AsmGenerator::visitWhileLoop(WhileLoop* w) {
+    std::string top = newLabel(), end = newLabel();
+    placeLabel(top);
+    branchIfFalse(w->condition, end);
+    compileBlock(w->body);
+    emit("jmp " + top);
+    placeLabel(end);
+    return ValueType::Int;
+}
+
+ValueType AsmGenerator::visitForLoop(ForLoop* f) {
+    if (f->initialization) visit(f->initialization);
+
+    std::string top = newLabel(), end = newLabel();
+    placeLabel(top);
+    branchIfFalse(f->condition, end);
+    compileBlock(f->body);
+    if (f->increment) visit(f->increment);  // Evaluated and discarded
+    emit("jmp " + top);
+    placeLabel(end);
+    return ValueType::Int;
+}
+
+ValueType AsmGenerator::visitReturnStatement(ReturnStatement* r) {
+    // `return` ends the program; its value is evaluated and discarded
+    if (r->expression) visit(r->expression);
+    emit("jmp .Lexit");
+    return ValueType::Int;
+}
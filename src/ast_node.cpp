@@ -1,5 +1,43 @@
 #include "../include/ast_node.h"
 #include <sstream>
+#include <stdexcept>
+
+const char* nodeKindToString(NodeKind kind) {
+    switch (kind) {
+        case NodeKind::Program: return "Program";
+        case NodeKind::Declaration: return "Declaration";
+        case NodeKind::Assignment: return "Assignment";
+        case NodeKind::BinaryOp: return "BinaryOp";
+        case NodeKind::UnaryOp: return "UnaryOp";
+        case NodeKind::Literal: return "Literal";
+        case NodeKind::Identifier: return "Identifier";
+        case NodeKind::FunctionCall: return "FunctionCall";
+        case NodeKind::IfStatement: return "IfStatement";
+        case NodeKind::WhileLoop: return "WhileLoop";
+        case NodeKind::ForLoop: return "ForLoop";
+        case NodeKind::ReturnStatement: return "ReturnStatement";
+        case NodeKind::Function: return "Function";
+        default: return "Unknown";
+    }
+}
+
+const char* valueTypeToString(ValueType type) {
+    switch (type) {
+        case ValueType::Int: return "int";
+        case ValueType::Float: return "float";
+        case ValueType::Bool: return "bool";
+        case ValueType::String: return "string";
+    }
+    return "unknown";
+}
+
+ValueType valueTypeFromName(const std::string& name) {
+    if (name == "int") return ValueType::Int;
+    if (name == "float") return ValueType::Float;
+    if (name == "bool") return ValueType::Bool;
+    if (name == "string") return ValueType::String;
+    throw std::runtime_error("Unknown type '" + name + "'");
+}
 
 std::string Program::toString() const {
     std::stringstream ss;
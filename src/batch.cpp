@@ -0,0 +1,201 @@
+#include "../include/batch.h"
+#include "../include/driver.h"
+#include "../include/compile_cache.h"
+#include "../include/binary_format.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Diagnostics for one file of the report
+struct FileResult {
+    std::string path;
+    std::string ioError;
+    std::vector<std::shared_ptr<Error>> errors;
+    
+    bool hasErrors() const { return !ioError.empty() || !errors.empty(); }
+};
+
+static std::vector<std::string> collectSourceFiles(const std::string& directory) {
+    std::vector<std::string> files;
+    for (const auto& entry : fs::recursive_directory_iterator(directory)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".code") {
+            files.push_back(entry.path().generic_string());
+        }
+    }
+    // Sort so the report order does not depend on directory iteration order
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// Diagnostics of files already compiled in this run, by content
+using DiagnosticsCache = CompileCache<std::vector<std::shared_ptr<Error>>>;
+
+// `git describe` of the source tree, set by CMake
+#ifndef COMPILER_VERSION
+#define COMPILER_VERSION "unknown"
+#endif
+
+// Seeds the --cache-dir entry names so that entries written by any other
+// build are never reused: the compiler version, the binary format version
+// and, where the running executable can be read, a hash of the executable
+// itself, which changes with every rebuild
+static std::string diskCacheSalt() {
+    std::string salt = "59LANG batch diagnostics/" COMPILER_VERSION "/" + std::to_string(BINARY_FORMAT_VERSION);
+#ifdef __linux__
+    std::string ioError;
+    if (auto self = SourceBuffer::fromFile("/proc/self/exe", ioError)) {
+        salt += "/" + std::to_string(hashBytes(self->view()));
+    }
+#endif
+    return salt;
+}
+
+// --cache-dir entries are binary files (binary_format.h) holding only the
+// errors table; returns false for an entry that cannot be read
+static bool readDiagnostics(const SourceBuffer& entry, std::vector<std::shared_ptr<Error>>& errors) {
+    try {
+        std::string_view data = entry.view();
+        BinaryReader reader(data.data(), data.size());
+        for (size_t i = 0; i < reader.errorCount(); ++i) {
+            BinaryError e = reader.error(i);
+            errors.push_back(std::make_shared<Error>(std::string(e.message), e.line, e.column, e.type));
+        }
+        return true;
+    } catch (const std::runtime_error&) {
+        errors.clear();
+        return false;
+    }
+}
+
+static std::string serializeDiagnostics(const std::vector<std::shared_ptr<Error>>& errors) {
+    std::ostringstream out;
+    writeBinary(out, {}, nullptr, errors);
+    return out.str();
+}
+
+// The --cache-dir, if any, and how many of its entries could be used
+struct DiskCacheUse {
+    std::unique_ptr<DiskCache> cache;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+};
+
+// Memory held by a result's diagnostics, for the cache's byte budget
+static size_t diagnosticsBytes(const std::vector<std::shared_ptr<Error>>& errors) {
+    size_t bytes = errors.capacity() * sizeof(std::shared_ptr<Error>);
+    for (const auto& e : errors) bytes += sizeof(Error) + e->message.capacity() + e->context.capacity();
+    return bytes;
+}
+
+static FileResult compileFile(const std::string& path, DiagnosticsCache& cache, DiskCacheUse& disk) {
+    FileResult result;
+    result.path = path;
+    
+    auto source = SourceBuffer::fromFile(path, result.ioError);
+    if (!source) return result;
+    
+    // Copies of a file (vendored examples, generated fixtures) are parsed once
+    if (auto cached = cache.find(source->view(), 0)) {
+        result.errors = std::move(*cached);
+        return result;
+    }
+    
+    if (disk.cache) {
+        auto entry = disk.cache->find(source->view());
+        if (entry && readDiagnostics(*entry, result.errors)) {
+            ++disk.hits;
+            cache.insert(source->view(), 0, result.errors, diagnosticsBytes(result.errors));
+            return result;
+        }
+        ++disk.misses;
+    }
+    
+    // The report only carries diagnostics, so the token stream is not kept
+    Parser parser(source, false);
+    parser.parse();
+    result.errors = parser.getErrors();
+    cache.insert(source->view(), 0, result.errors, diagnosticsBytes(result.errors));
+    if (disk.cache) disk.cache->insert(source->view(), serializeDiagnostics(result.errors));
+    return result;
+}
+
+static void writeFileResult(JsonWriter& json, const FileResult& result) {
+    json.beginObject();
+    json.key("path").value(result.path);
+    json.key("hasErrors").value(result.hasErrors());
+    // A file that could not be read has no diagnostics, only "ioError"
+    json.key("errorCount").value(static_cast<uint64_t>(result.errors.size()));
+    json.key("errors");
+    writeErrors(json, result.errors);
+    if (!result.ioError.empty()) json.key("ioError").value(result.ioError);
+    json.endObject();
+}
+
+int runBatch(const std::string& directory, unsigned jobs, std::ostream& out, bool pretty, size_t cacheBytes,
+             const std::string& cacheDir) {
+    std::vector<std::string> files;
+    DiskCacheUse disk;
+    try {
+        files = collectSourceFiles(directory);
+        if (!cacheDir.empty()) disk.cache = std::make_unique<DiskCache>(cacheDir, diskCacheSalt());
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+    jobs = std::min<unsigned>(jobs, std::max<size_t>(files.size(), 1));
+    
+    // Workers claim files through a shared counter and write only to their
+    // own result slot, so no locking is needed
+    std::vector<FileResult> results(files.size());
+    std::atomic<size_t> next(0);
+    DiagnosticsCache cache(cacheBytes);
+    auto worker = [&]() {
+        for (size_t i = next++; i < files.size(); i = next++) {
+            results[i] = compileFile(files[i], cache, disk);
+        }
+    };
+    
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < jobs; ++i) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+    
+    int failed = 0;
+    for (const auto& r : results) {
+        if (r.hasErrors()) failed++;
+    }
+    
+    JsonWriter json(out, pretty);
+    json.beginObject();
+    json.key("directory").value(directory);
+    json.key("jobs").value(static_cast<uint64_t>(jobs));
+    json.key("fileCount").value(static_cast<uint64_t>(files.size()));
+    json.key("failedCount").value(failed);
+    json.key("cache").beginObject();
+    json.key("hits").value(cache.getHits());
+    json.key("misses").value(cache.getMisses());
+    if (disk.cache) {
+        json.key("diskHits").value(disk.hits.load());
+        json.key("diskMisses").value(disk.misses.load());
+    }
+    json.endObject();
+    json.key("files").beginArray();
+    for (const auto& r : results) writeFileResult(json, r);
+    json.endArray();
+    json.endObject();
+    json.flush();
+    out << std::endl;
+    
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,341 @@
+#include "../include/binary_format.h"
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+static constexpr char MAGIC[4] = {'5', '9', 'A', 'B'};
+static constexpr size_t HEADER_SIZE = 56;
+static constexpr size_t TOKEN_SIZE = 20;
+static constexpr size_t NODE_SIZE = 40;
+static constexpr size_t CHILD_SIZE = 4;
+static constexpr size_t ERROR_SIZE = 20;
+
+static void put16(std::string& out, uint16_t v) {
+    out.push_back(static_cast<char>(v & 0xFF));
+    out.push_back(static_cast<char>(v >> 8));
+}
+
+static void put32(std::string& out, uint32_t v) {
+    for (int shift = 0; shift < 32; shift += 8) out.push_back(static_cast<char>((v >> shift) & 0xFF));
+}
+
+static uint16_t get16(const char* p) {
+    auto b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+static uint32_t get32(const char* p) {
+    auto b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+           (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+static uint32_t checkedSize(size_t n) {
+    if (n > 0xFFFFFFFFu) throw std::runtime_error("Binary output exceeds 4 GiB");
+    return static_cast<uint32_t>(n);
+}
+
+// Accumulates the tables; strings are interned so repeated names and
+// operators are stored once
+class BinaryWriter {
+public:
+    std::string tokens, nodes, children, errors, strings;
+    uint32_t tokenCount = 0, nodeCount = 0, childCount = 0;
+
+    void addToken(const Token& t) {
+        put32(tokens, static_cast<uint32_t>(t.type));
+        put32(tokens, static_cast<uint32_t>(t.line));
+        put32(tokens, static_cast<uint32_t>(t.column));
+        putString(tokens, t.value);
+        ++tokenCount;
+    }
+
+    void addError(const Error& e) {
+        put32(errors, static_cast<uint32_t>(e.type));
+        put32(errors, static_cast<uint32_t>(e.line));
+        put32(errors, static_cast<uint32_t>(e.column));
+        putString(errors, e.message);
+    }
+
+    // Nodes are numbered in pre-order; each node's children are contiguous
+    // in the child table
+    uint32_t addNode(ASTNodePtr n) {
+        if (!n) return NO_NODE;
+
+        uint32_t index = nodeCount++;
+        nodes.resize(nodes.size() + NODE_SIZE);
+
+        std::vector<uint32_t> kids;
+        auto each = [&](const ASTNodeList& list) {
+            for (ASTNodePtr child : list) kids.push_back(addNode(child));
+        };
+        std::string_view text, text2;
+        uint32_t split = 0;
+
+        switch (n->kind) {
+            case NodeKind::Program: {
+                auto p = static_cast<Program*>(n);
+                text = p->name;
+                split = checkedSize(p->declarations.size());
+                each(p->declarations);
+                each(p->statements);
+                break;
+            }
+            case NodeKind::Declaration: {
+                auto d = static_cast<Declaration*>(n);
+                text = d->dataType;
+                for (size_t i = 0; i < d->identifiers.size(); ++i) {
+                    kids.push_back(addName(d->identifiers[i], d));
+                    kids.push_back(i < d->initializers.size() ? addNode(d->initializers[i]) : NO_NODE);
+                }
+                break;
+            }
+            case NodeKind::Assignment: {
+                auto a = static_cast<Assignment*>(n);
+                text = a->identifier;
+                kids.push_back(addNode(a->expression));
+                break;
+            }
+            case NodeKind::BinaryOp: {
+                auto b = static_cast<BinaryOp*>(n);
+                text = b->operation;
+                kids.push_back(addNode(b->left));
+                kids.push_back(addNode(b->right));
+                break;
+            }
+            case NodeKind::UnaryOp: {
+                auto u = static_cast<UnaryOp*>(n);
+                text = u->operation;
+                kids.push_back(addNode(u->operand));
+                break;
+            }
+            case NodeKind::Literal: {
+                auto l = static_cast<Literal*>(n);
+                text = l->value;
+                text2 = l->dataType;
+                break;
+            }
+            case NodeKind::Identifier:
+                text = static_cast<Identifier*>(n)->name;
+                break;
+            case NodeKind::FunctionCall: {
+                auto f = static_cast<FunctionCall*>(n);
+                text = f->functionName;
+                each(f->arguments);
+                break;
+            }
+            case NodeKind::IfStatement: {
+                auto iff = static_cast<IfStatement*>(n);
+                split = checkedSize(iff->thenBranch.size());
+                kids.push_back(addNode(iff->condition));
+                each(iff->thenBranch);
+                each(iff->elseBranch);
+                break;
+            }
+            case NodeKind::WhileLoop: {
+                auto w = static_cast<WhileLoop*>(n);
+                kids.push_back(addNode(w->condition));
+                each(w->body);
+                break;
+            }
+            case NodeKind::ForLoop: {
+                auto f = static_cast<ForLoop*>(n);
+                kids.push_back(addNode(f->initialization));
+                kids.push_back(addNode(f->condition));
+                kids.push_back(addNode(f->increment));
+                each(f->body);
+                break;
+            }
+            case NodeKind::ReturnStatement:
+                kids.push_back(addNode(static_cast<ReturnStatement*>(n)->expression));
+                break;
+            case NodeKind::Function: {
+                auto fn = static_cast<Function*>(n);
+                text = fn->name;
+                text2 = fn->returnType;
+                split = checkedSize(fn->parameters.size());
+                each(fn->parameters);
+                each(fn->body);
+                break;
+            }
+        }
+
+        uint32_t firstChild = childCount;
+        for (uint32_t kid : kids) put32(children, kid);
+        childCount += checkedSize(kids.size());
+
+        uint8_t valueType = n->valueType ? static_cast<uint8_t>(*n->valueType) + 1 : 0;
+        writeNode(index, n->kind, valueType, n->line, n->column, split, text, text2, firstChild,
+                  checkedSize(kids.size()));
+        return index;
+    }
+
+private:
+    std::unordered_map<std::string_view, uint32_t> interned;
+
+    void putString(std::string& out, std::string_view s) {
+        auto it = interned.find(s);
+        uint32_t offset;
+        if (it != interned.end()) {
+            offset = it->second;
+        } else {
+            offset = checkedSize(strings.size());
+            strings.append(s.data(), s.size());
+            interned.emplace(s, offset);
+        }
+        put32(out, offset);
+        put32(out, checkedSize(s.size()));
+    }
+
+    // A name declared by `d`, stored as an Identifier node
+    uint32_t addName(std::string_view name, Declaration* d) {
+        uint32_t index = nodeCount++;
+        nodes.resize(nodes.size() + NODE_SIZE);
+        writeNode(index, NodeKind::Identifier, 0, d->line, d->column, 0, name, {}, childCount, 0);
+        return index;
+    }
+
+    void writeNode(uint32_t index, NodeKind kind, uint8_t valueType, int line, int column, uint32_t split,
+                   std::string_view text, std::string_view text2, uint32_t firstChild, uint32_t count) {
+        std::string record;
+        record.push_back(static_cast<char>(kind));
+        record.push_back(static_cast<char>(valueType));
+        put16(record, 0);
+        put32(record, static_cast<uint32_t>(line));
+        put32(record, static_cast<uint32_t>(column));
+        put32(record, split);
+        putString(record, text);
+        putString(record, text2);
+        put32(record, firstChild);
+        put32(record, count);
+        std::memcpy(&nodes[static_cast<size_t>(index) * NODE_SIZE], record.data(), NODE_SIZE);
+    }
+};
+
+void writeBinary(std::ostream& out, const std::vector<Token>& tokens, ASTNodePtr ast,
+                 const std::vector<std::shared_ptr<Error>>& errors) {
+    BinaryWriter writer;
+    for (const Token& t : tokens) writer.addToken(t);
+    uint32_t root = writer.addNode(ast);
+    for (const auto& e : errors) writer.addError(*e);
+
+    // Tables follow the header in this order
+    const std::string* tables[] = {&writer.tokens, &writer.nodes, &writer.children, &writer.errors,
+                                   &writer.strings};
+    uint32_t counts[] = {writer.tokenCount, writer.nodeCount, writer.childCount,
+                         checkedSize(errors.size()), checkedSize(writer.strings.size())};
+
+    std::string header(MAGIC, sizeof(MAGIC));
+    put16(header, BINARY_FORMAT_VERSION);
+    put16(header, errors.empty() ? 0 : 1);
+    size_t fileSize = HEADER_SIZE;
+    for (const std::string* table : tables) fileSize += table->size();
+    put32(header, checkedSize(fileSize));
+    put32(header, root);
+
+    size_t offset = HEADER_SIZE;
+    for (size_t i = 0; i < 5; ++i) {
+        put32(header, checkedSize(offset));
+        put32(header, counts[i]);
+        offset += tables[i]->size();
+    }
+
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    for (const std::string* table : tables) out.write(table->data(), static_cast<std::streamsize>(table->size()));
+}
+
+BinaryReader::BinaryReader(const char* d, size_t s) : data(d), size(s) {
+    if (size < HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a 59LANG binary file");
+    }
+    version = get16(data + 4);
+    if (version != BINARY_FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported binary format version " + std::to_string(version));
+    }
+    flags = get16(data + 6);
+    if (get32(data + 8) != size) throw std::runtime_error("Binary file is truncated");
+    rootNode = get32(data + 12);
+
+    Table* tables[] = {&tokens, &nodes, &children, &errors, &strings};
+    const size_t recordSizes[] = {TOKEN_SIZE, NODE_SIZE, CHILD_SIZE, ERROR_SIZE, 1};
+    for (size_t i = 0; i < 5; ++i) {
+        const char* entry = data + 16 + i * 8;
+        tables[i]->offset = get32(entry);
+        tables[i]->count = get32(entry + 4);
+        uint64_t end = uint64_t(tables[i]->offset) + uint64_t(tables[i]->count) * recordSizes[i];
+        if (tables[i]->offset < HEADER_SIZE || end > size) throw std::runtime_error("Binary table out of bounds");
+    }
+    if (rootNode != NO_NODE && rootNode >= nodes.count) throw std::runtime_error("Binary root node out of range");
+}
+
+BinaryReader BinaryReader::fromFile(const std::string& path) {
+    std::string ioError;
+    auto file = SourceBuffer::fromFile(path, ioError);
+    if (!file) throw std::runtime_error(ioError);
+
+    std::string_view bytes = file->view();
+    BinaryReader reader(bytes.data(), bytes.size());
+    reader.file = std::move(file);
+    return reader;
+}
+
+const char* BinaryReader::record(const Table& table, size_t index, size_t recordSize) const {
+    if (index >= table.count) throw std::runtime_error("Binary record index out of range");
+    return data + table.offset + index * recordSize;
+}
+
+std::string_view BinaryReader::string(const char* ref) const {
+    uint32_t offset = get32(ref), length = get32(ref + 4);
+    if (uint64_t(offset) + length > strings.count) throw std::runtime_error("Binary string out of bounds");
+    return std::string_view(data + strings.offset + offset, length);
+}
+
+BinaryToken BinaryReader::token(size_t index) const {
+    const char* r = record(tokens, index, TOKEN_SIZE);
+    if (get32(r) > static_cast<uint32_t>(TokenType::ERROR_TOKEN)) {
+        throw std::runtime_error("Binary token " + std::to_string(index) + " is malformed");
+    }
+    return {static_cast<TokenType>(get32(r)), string(r + 12), static_cast<int>(get32(r + 4)),
+            static_cast<int>(get32(r + 8))};
+}
+
+BinaryNode BinaryReader::node(uint32_t index) const {
+    const char* r = record(nodes, index, NODE_SIZE);
+    uint8_t kind = static_cast<uint8_t>(r[0]);
+    uint8_t valueType = static_cast<uint8_t>(r[1]);
+    if (kind > static_cast<uint8_t>(NodeKind::Function) || valueType > static_cast<uint8_t>(ValueType::String) + 1) {
+        throw std::runtime_error("Binary node " + std::to_string(index) + " is malformed");
+    }
+
+    BinaryNode n;
+    n.index = index;
+    n.kind = static_cast<NodeKind>(kind);
+    if (valueType) n.valueType = static_cast<ValueType>(valueType - 1);
+    n.line = static_cast<int>(get32(r + 4));
+    n.column = static_cast<int>(get32(r + 8));
+    n.split = get32(r + 12);
+    n.text = string(r + 16);
+    n.text2 = string(r + 24);
+    n.firstChild = get32(r + 32);
+    n.childCount = get32(r + 36);
+    if (uint64_t(n.firstChild) + n.childCount > children.count || n.split > n.childCount) {
+        throw std::runtime_error("Binary node " + std::to_string(index) + " is malformed");
+    }
+    return n;
+}
+
+uint32_t BinaryReader::child(const BinaryNode& n, size_t index) const {
+    if (index >= n.childCount) throw std::runtime_error("Binary child index out of range");
+    uint32_t node = get32(record(children, n.firstChild + index, CHILD_SIZE));
+    if (node != NO_NODE && (node <= n.index || node >= nodes.count)) throw std::runtime_error("Binary child node out of range");
+    return node;
+}
+
+BinaryError BinaryReader::error(size_t index) const {
+    const char* r = record(errors, index, ERROR_SIZE);
+    if (get32(r) > static_cast<uint32_t>(ErrorType::RUNTIME)) {
+        throw std::runtime_error("Binary error " + std::to_string(index) + " is malformed");
+    }
+    return {static_cast<ErrorType>(get32(r)), string(r + 12), static_cast<int>(get32(r + 4)),
+            static_cast<int>(get32(r + 8))};
+}
@@ -0,0 +1,133 @@
+#include "../include/bytecode.h"
+#include <cstdio>
+
+std::string valueToString(const Value& value) {
+    switch (value.type) {
+        case ValueType::Int: return std::to_string(value.i);
+        case ValueType::Float: {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.15g", value.f);
+            return buffer;
+        }
+        case ValueType::Bool: return value.b ? "true" : "false";
+        case ValueType::String: return *value.s;
+    }
+    return "";
+}
+
+const char* opCodeToString(OpCode op) {
+    switch (op) {
+        case OpCode::PushConst: return "PUSH_CONST";
+        case OpCode::Load: return "LOAD";
+        case OpCode::Store: return "STORE";
+        case OpCode::Pop: return "POP";
+        case OpCode::Add: return "ADD";
+        case OpCode::Sub: return "SUB";
+        case OpCode::Mul: return "MUL";
+        case OpCode::Div: return "DIV";
+        case OpCode::Mod: return "MOD";
+        case OpCode::Pow: return "POW";
+        case OpCode::Neg: return "NEG";
+        case OpCode::Not: return "NOT";
+        case OpCode::Equal: return "EQ";
+        case OpCode::NotEqual: return "NE";
+        case OpCode::Less: return "LT";
+        case OpCode::LessEqual: return "LE";
+        case OpCode::Greater: return "GT";
+        case OpCode::GreaterEqual: return "GE";
+        case OpCode::Jump: return "JUMP";
+        case OpCode::JumpIfFalse: return "JUMP_IF_FALSE";
+        case OpCode::JumpIfTrue: return "JUMP_IF_TRUE";
+        case OpCode::Print: return "PRINT";
+        case OpCode::Read: return "READ";
+        case OpCode::Halt: return "HALT";
+        case OpCode::IncLocal: return "INC_LOCAL";
+        case OpCode::CmpLocalConstJump: return "CMP_LOCAL_CONST_JUMP";
+        case OpCode::PrintLocal: return "PRINT_LOCAL";
+        case OpCode::AddInt: return "ADD_INT";
+        case OpCode::SubInt: return "SUB_INT";
+        case OpCode::MulInt: return "MUL_INT";
+        case OpCode::DivInt: return "DIV_INT";
+        case OpCode::ModInt: return "MOD_INT";
+        case OpCode::AddFloat: return "ADD_FLOAT";
+        case OpCode::SubFloat: return "SUB_FLOAT";
+        case OpCode::MulFloat: return "MUL_FLOAT";
+        case OpCode::DivFloat: return "DIV_FLOAT";
+        case OpCode::NegInt: return "NEG_INT";
+        case OpCode::NegFloat: return "NEG_FLOAT";
+        case OpCode::NotBool: return "NOT_BOOL";
+        case OpCode::ToFloat: return "TO_FLOAT";
+        case OpCode::CompareInt: return "CMP_INT";
+        case OpCode::CompareFloat: return "CMP_FLOAT";
+        case OpCode::StoreDirect: return "STORE_DIRECT";
+        case OpCode::JumpIfFalseBool: return "JUMP_IF_FALSE_BOOL";
+        case OpCode::JumpIfTrueBool: return "JUMP_IF_TRUE_BOOL";
+        case OpCode::CmpIntJump: return "CMP_INT_JUMP";
+        case OpCode::IncLocalInt: return "INC_LOCAL_INT";
+        case OpCode::CmpLocalConstJumpInt: return "CMP_LOCAL_CONST_JUMP_INT";
+    }
+    return "UNKNOWN";
+}
+
+int fusedInstructionSavings(OpCode op) {
+    switch (op) {
+        case OpCode::IncLocal:
+        case OpCode::IncLocalInt: return 3;           // LOAD, PUSH_CONST, ADD, STORE
+        case OpCode::CmpLocalConstJump:
+        case OpCode::CmpLocalConstJumpInt: return 3;  // LOAD, PUSH_CONST, <cmp>, JUMP_IF_FALSE
+        case OpCode::PrintLocal: return 1;            // LOAD, PRINT
+        case OpCode::CmpIntJump: return 1;            // <cmp>, JUMP_IF_FALSE
+        default: return 0;
+    }
+}
+
+void disassemble(const Chunk& chunk, std::ostream& out) {
+    char pc[32];
+    for (size_t i = 0; i < chunk.code.size(); ++i) {
+        const Instruction& in = chunk.code[i];
+        std::snprintf(pc, sizeof(pc), "%04zu  ", i);
+        out << pc << opCodeToString(in.op);
+
+        switch (in.op) {
+            case OpCode::PushConst: {
+                const Value& v = chunk.constants[in.a];
+                out << " " << in.a << " (" << valueTypeToString(v.type) << " " << valueToString(v) << ")";
+                break;
+            }
+            case OpCode::Load:
+            case OpCode::Store:
+            case OpCode::StoreDirect:
+            case OpCode::Read:
+            case OpCode::PrintLocal:
+                out << " " << in.a << " (" << chunk.slotNames[in.a] << ")";
+                break;
+            case OpCode::IncLocal:
+            case OpCode::IncLocalInt:
+                out << " " << in.a << " (" << chunk.slotNames[in.a] << ") += "
+                    << valueToString(chunk.constants[in.b]);
+                break;
+            case OpCode::CmpLocalConstJump:
+            case OpCode::CmpLocalConstJumpInt:
+                out << " " << in.a << " (" << chunk.slotNames[in.a] << ") " << opCodeToString(in.cmp)
+                    << " " << valueToString(chunk.constants[in.b]) << " else -> " << in.c;
+                break;
+            case OpCode::CompareInt:
+            case OpCode::CompareFloat:
+                out << " " << opCodeToString(in.cmp);
+                break;
+            case OpCode::CmpIntJump:
+                out << " " << opCodeToString(in.cmp) << " else -> " << in.a;
+                break;
+            case OpCode::Jump:
+            case OpCode::JumpIfFalse:
+            case OpCode::JumpIfTrue:
+            case OpCode::JumpIfFalseBool:
+            case OpCode::JumpIfTrueBool:
+                out << " -> " << in.a;
+                break;
+            default:
+                break;
+        }
+        out << "\n";
+    }
+}
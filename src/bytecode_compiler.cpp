@@ -0,0 +1,401 @@
+#include "../include/bytecode_compiler.h"
+#include <stdexcept>
+
+// Net operand stack effect of each instruction
+static int stackEffect(OpCode op) {
+    switch (op) {
+        case OpCode::PushConst:
+        case OpCode::Load:
+            return 1;
+        case OpCode::Store:
+        case OpCode::Pop:
+        case OpCode::Add: case OpCode::Sub: case OpCode::Mul:
+        case OpCode::Div: case OpCode::Mod: case OpCode::Pow:
+        case OpCode::Equal: case OpCode::NotEqual:
+        case OpCode::Less: case OpCode::LessEqual:
+        case OpCode::Greater: case OpCode::GreaterEqual:
+        case OpCode::JumpIfFalse:
+        case OpCode::JumpIfTrue:
+        case OpCode::Print:
+        case OpCode::AddInt: case OpCode::SubInt: case OpCode::MulInt:
+        case OpCode::DivInt: case OpCode::ModInt:
+        case OpCode::AddFloat: case OpCode::SubFloat:
+        case OpCode::MulFloat: case OpCode::DivFloat:
+        case OpCode::CompareInt: case OpCode::CompareFloat:
+        case OpCode::StoreDirect:
+        case OpCode::JumpIfFalseBool:
+        case OpCode::JumpIfTrueBool:
+            return -1;
+        case OpCode::CmpIntJump:
+            return -2;
+        // IncLocal, CmpLocalConstJump and PrintLocal work on slots directly;
+        // Neg, Not and ToFloat replace the top of the stack
+        default:
+            return 0;
+    }
+}
+
+Chunk BytecodeCompiler::compile(ASTNodePtr program) {
+    chunk = Chunk();
+    slots.clear();
+    depth = 0;
+
+    visit(program);
+    emit(OpCode::Halt);
+    return std::move(chunk);
+}
+
+size_t BytecodeCompiler::emit(OpCode op, int32_t a, int32_t b) {
+    chunk.code.emplace_back(op, a, b);
+    adjustDepth(stackEffect(op));
+    return chunk.code.size() - 1;
+}
+
+void BytecodeCompiler::adjustDepth(int delta) {
+    depth += delta;
+    if (depth > chunk.maxStack) chunk.maxStack = depth;
+}
+
+void BytecodeCompiler::patchJump(size_t at) {
+    Instruction& jump = chunk.code[at];
+    int32_t target = static_cast<int32_t>(here());
+    if (jump.op == OpCode::CmpLocalConstJump || jump.op == OpCode::CmpLocalConstJumpInt) {
+        jump.c = target;
+    } else {
+        jump.a = target;
+    }
+}
+
+int32_t BytecodeCompiler::addConstant(Value value) {
+    chunk.constants.push_back(value);
+    return static_cast<int32_t>(chunk.constants.size() - 1);
+}
+
+int32_t BytecodeCompiler::declareSlot(std::string_view name, ValueType type) {
+    auto it = slots.find(name);
+    if (it != slots.end()) return it->second;
+
+    int32_t slot = static_cast<int32_t>(chunk.slotNames.size());
+    chunk.slotNames.emplace_back(name);
+    chunk.slotTypes.push_back(type);
+    slots.emplace(name, slot);
+    return slot;
+}
+
+int32_t BytecodeCompiler::slotFor(std::string_view name) const {
+    auto it = slots.find(name);
+    if (it == slots.end()) {
+        throw std::runtime_error("Symbol '" + std::string(name) + "' not declared");
+    }
+    return it->second;
+}
+
+void BytecodeCompiler::compileBlock(const ASTNodeList& statements) {
+    for (ASTNodePtr stmt : statements) {
+        if (stmt) visit(stmt);
+    }
+}
+
+static OpCode comparisonOpCode(std::string_view op) {
+    if (op == "<") return OpCode::Less;
+    if (op == "<=") return OpCode::LessEqual;
+    if (op == ">") return OpCode::Greater;
+    if (op == ">=") return OpCode::GreaterEqual;
+    if (op == "==") return OpCode::Equal;
+    if (op == "!=") return OpCode::NotEqual;
+    return OpCode::Halt;
+}
+
+size_t BytecodeCompiler::compileCondition(ASTNodePtr condition) {
+    auto cmp = nodeAs<BinaryOp>(condition);
+    OpCode comparison = cmp ? comparisonOpCode(cmp->operation) : OpCode::Halt;
+    if (fuse && comparison != OpCode::Halt) {
+        auto local = nodeAs<Identifier>(cmp->left);
+        auto constant = nodeAs<Literal>(cmp->right);
+        if (local && constant) {
+            int32_t slot = slotFor(local->name);
+            Value limit = literalValue(constant);
+            bool typed = specialize && chunk.slotTypes[slot] == ValueType::Int && limit.type == ValueType::Int;
+            size_t at = emit(typed ? OpCode::CmpLocalConstJumpInt : OpCode::CmpLocalConstJump, slot,
+                             addConstant(limit));
+            chunk.code[at].cmp = comparison;
+            return at;
+        }
+
+        // Core guard: compare and branch in one instruction
+        if (staticType(cmp->left) == ValueType::Int && staticType(cmp->right) == ValueType::Int) {
+            visit(cmp->left);
+            visit(cmp->right);
+            size_t at = emit(OpCode::CmpIntJump);
+            chunk.code[at].cmp = comparison;
+            return at;
+        }
+    }
+
+    visit(condition);
+    return emit(staticType(condition) == ValueType::Bool ? OpCode::JumpIfFalseBool : OpCode::JumpIfFalse);
+}
+
+// The checker's type for `expression`, if specializing on it
+std::optional<ValueType> BytecodeCompiler::staticType(ASTNodePtr expression) const {
+    if (!specialize || !expression) return std::nullopt;
+    return expression->valueType;
+}
+
+// Evaluate `value` into `slot`, converting it to the slot's type
+void BytecodeCompiler::compileStore(ASTNodePtr value, int32_t slot) {
+    visit(value);
+
+    ValueType target = chunk.slotTypes[slot];
+    std::optional<ValueType> type = staticType(value);
+    if (type == ValueType::Int && target == ValueType::Float) {
+        emit(OpCode::ToFloat);
+        type = target;
+    }
+    emit(type == target ? OpCode::StoreDirect : OpCode::Store, slot);
+}
+
+// x = x + c / x = x - c for a numeric variable and numeric literal
+bool BytecodeCompiler::fuseIncrement(Assignment* a) {
+    auto sum = nodeAs<BinaryOp>(a->expression);
+    if (!sum || (sum->operation != "+" && sum->operation != "-")) return false;
+
+    auto local = nodeAs<Identifier>(sum->left);
+    auto constant = nodeAs<Literal>(sum->right);
+    if (!local || !constant || local->name != a->identifier) return false;
+    if (constant->dataType != "int" && constant->dataType != "float") return false;
+
+    int32_t slot = slotFor(a->identifier);
+    ValueType type = chunk.slotTypes[slot];
+    if (type != ValueType::Int && type != ValueType::Float) return false;
+
+    Value step = literalValue(constant);
+    bool typed = specialize && type == ValueType::Int && step.type == ValueType::Int;
+    if (sum->operation == "-") {
+        if (step.type == ValueType::Int) {
+            step.i = static_cast<int64_t>(0 - static_cast<uint64_t>(step.i));
+        } else {
+            step.f = -step.f;
+        }
+    }
+    emit(typed ? OpCode::IncLocalInt : OpCode::IncLocal, slot, addConstant(step));
+    return true;
+}
+
+void BytecodeCompiler::visitNode(ASTNodePtr node) {
+    throw std::runtime_error(std::string("Cannot compile ") + nodeKindToString(node->kind) + " node");
+}
+
+void BytecodeCompiler::visitProgram(Program* p) {
+    compileBlock(p->declarations);
+    compileBlock(p->statements);
+}
+
+void BytecodeCompiler::visitDeclaration(Declaration* d) {
+    ValueType type = valueTypeFromName(std::string(d->dataType));
+
+    for (size_t i = 0; i < d->identifiers.size(); ++i) {
+        int32_t slot = declareSlot(d->identifiers[i], type);
+        ASTNodePtr init = i < d->initializers.size() ? d->initializers[i] : nullptr;
+
+        // Re-running a declaration (e.g. inside a loop body) resets the variable
+        if (init) {
+            compileStore(init, slot);
+        } else {
+            Value zero;
+            switch (type) {
+                case ValueType::Int: zero = Value::ofInt(0); break;
+                case ValueType::Float: zero = Value::ofFloat(0.0); break;
+                case ValueType::Bool: zero = Value::ofBool(false); break;
+                case ValueType::String:
+                    chunk.strings.emplace_back();
+                    zero = Value::ofString(&chunk.strings.back());
+                    break;
+            }
+            emit(OpCode::PushConst, addConstant(zero));
+            emit(specialize ? OpCode::StoreDirect : OpCode::Store, slot);
+        }
+    }
+}
+
+void BytecodeCompiler::visitAssignment(Assignment* a) {
+    if (fuse && fuseIncrement(a)) return;
+    
+    compileStore(a->expression, slotFor(a->identifier));
+}
+
+void BytecodeCompiler::visitBinaryOp(BinaryOp* b) {
+    std::string_view op = b->operation;
+
+    // Short-circuit operators always produce a bool
+    if (op == "&&" || op == "||") {
+        bool isAnd = (op == "&&");
+        bool shortValue = !isAnd;
+        auto shortCircuit = [&](ASTNodePtr operand) {
+            if (staticType(operand) == ValueType::Bool) {
+                return isAnd ? OpCode::JumpIfFalseBool : OpCode::JumpIfTrueBool;
+            }
+            return isAnd ? OpCode::JumpIfFalse : OpCode::JumpIfTrue;
+        };
+
+        visit(b->left);
+        size_t leftJump = emit(shortCircuit(b->left));
+        visit(b->right);
+        size_t rightJump = emit(shortCircuit(b->right));
+        emit(OpCode::PushConst, addConstant(Value::ofBool(!shortValue)));
+        size_t endJump = emit(OpCode::Jump);
+        patchJump(leftJump);
+        patchJump(rightJump);
+        emit(OpCode::PushConst, addConstant(Value::ofBool(shortValue)));
+        adjustDepth(-1);  // Only one of the two pushes executes
+        patchJump(endJump);
+        return;
+    }
+
+    OpCode generic = comparisonOpCode(op);
+    if (op == "+") generic = OpCode::Add;
+    else if (op == "-") generic = OpCode::Sub;
+    else if (op == "*") generic = OpCode::Mul;
+    else if (op == "/") generic = OpCode::Div;
+    else if (op == "%") generic = OpCode::Mod;
+    else if (op == "**") generic = OpCode::Pow;
+    else if (generic == OpCode::Halt) throw std::runtime_error("Unknown operator '" + std::string(op) + "'");
+
+    if (compileTypedBinary(b, generic)) return;
+
+    visit(b->left);
+    visit(b->right);
+    emit(generic);
+}
+
+// Core/flux arithmetic and comparisons with a typed opcode; false (nothing
+// emitted) if the operands' types are not known or the operation has no
+// typed form
+bool BytecodeCompiler::compileTypedBinary(BinaryOp* b, OpCode generic) {
+    auto isNumeric = [](std::optional<ValueType> type) {
+        return type == ValueType::Int || type == ValueType::Float;
+    };
+    std::optional<ValueType> left = staticType(b->left), right = staticType(b->right);
+    if (!isNumeric(left) || !isNumeric(right)) return false;
+
+    bool asFloat = left == ValueType::Float || right == ValueType::Float;
+    OpCode typed;
+    switch (generic) {
+        case OpCode::Add: typed = asFloat ? OpCode::AddFloat : OpCode::AddInt; break;
+        case OpCode::Sub: typed = asFloat ? OpCode::SubFloat : OpCode::SubInt; break;
+        case OpCode::Mul: typed = asFloat ? OpCode::MulFloat : OpCode::MulInt; break;
+        case OpCode::Div: typed = asFloat ? OpCode::DivFloat : OpCode::DivInt; break;
+        case OpCode::Mod:
+            if (asFloat) return false;
+            typed = OpCode::ModInt;
+            break;
+        case OpCode::Pow: return false;
+        default: typed = asFloat ? OpCode::CompareFloat : OpCode::CompareInt; break;
+    }
+
+    visit(b->left);
+    if (asFloat && left == ValueType::Int) emit(OpCode::ToFloat);
+    visit(b->right);
+    if (asFloat && right == ValueType::Int) emit(OpCode::ToFloat);
+
+    size_t at = emit(typed);
+    if (typed == OpCode::CompareInt || typed == OpCode::CompareFloat) chunk.code[at].cmp = generic;
+    return true;
+}
+
+void BytecodeCompiler::visitUnaryOp(UnaryOp* u) {
+    visit(u->operand);
+
+    std::optional<ValueType> type = staticType(u->operand);
+    if (u->operation == "-") {
+        emit(type == ValueType::Int ? OpCode::NegInt : type == ValueType::Float ? OpCode::NegFloat : OpCode::Neg);
+    } else {
+        emit(type == ValueType::Bool ? OpCode::NotBool : OpCode::Not);
+    }
+}
+
+Value BytecodeCompiler::literalValue(Literal* l) {
+    if (l->dataType == "int") {
+        try {
+            return Value::ofInt(std::stoll(std::string(l->value)));
+        } catch (const std::out_of_range&) {
+            throw std::runtime_error("Integer literal '" + std::string(l->value) + "' out of range");
+        }
+    }
+    if (l->dataType == "float") return Value::ofFloat(std::stod(std::string(l->value)));
+    if (l->dataType == "bool") return Value::ofBool(l->value == "true");
+
+    chunk.strings.emplace_back(l->value);
+    return Value::ofString(&chunk.strings.back());
+}
+
+void BytecodeCompiler::visitLiteral(Literal* l) {
+    emit(OpCode::PushConst, addConstant(literalValue(l)));
+}
+
+void BytecodeCompiler::visitIdentifier(Identifier* id) {
+    emit(OpCode::Load, slotFor(id->name));
+}
+
+void BytecodeCompiler::visitFunctionCall(FunctionCall* f) {
+    if (f->functionName == "input") {
+        auto target = nodeAs<Identifier>(f->arguments.empty() ? nullptr : f->arguments[0]);
+        if (!target) throw std::runtime_error("listen expects a variable");
+        emit(OpCode::Read, slotFor(target->name));
+    } else if (auto local = nodeAs<Identifier>(f->arguments.at(0)); fuse && local) {
+        emit(OpCode::PrintLocal, slotFor(local->name));
+    } else {
+        visit(f->arguments.at(0));
+        emit(OpCode::Print);
+    }
+}
+
+void BytecodeCompiler::visitIfStatement(IfStatement* iff) {
+    size_t elseJump = compileCondition(iff->condition);
+    compileBlock(iff->thenBranch);
+
+    if (iff->elseBranch.empty()) {
+        patchJump(elseJump);
+        return;
+    }
+
+    size_t endJump = emit(OpCode::Jump);
+    patchJump(elseJump);
+    compileBlock(iff->elseBranch);
+    patchJump(endJump);
+}
+
+void BytecodeCompiler::visitWhileLoop(WhileLoop* w) {
+    size_t loopStart = here();
+    size_t exitJump = compileCondition(w->condition);
+    compileBlock(w->body);
+    emit(OpCode::Jump, static_cast<int32_t>(loopStart));
+    patchJump(exitJump);
+}
+
+void BytecodeCompiler::visitForLoop(ForLoop* f) {
+    if (f->initialization) visit(f->initialization);
+
+    size_t loopStart = here();
+    size_t exitJump = compileCondition(f->condition);
+    compileBlock(f->body);
+
+    // The increment clause is an expression; evaluate it for its side
+    // effects (none today) and discard the result
+    if (f->increment) {
+        visit(f->increment);
+        emit(OpCode::Pop);
+    }
+    emit(OpCode::Jump, static_cast<int32_t>(loopStart));
+    patchJump(exitJump);
+}
+
+void BytecodeCompiler::visitReturnStatement(ReturnStatement* r) {
+    // `return` ends the program; its value is evaluated (so runtime errors
+    // still surface) and discarded
+    if (r->expression) {
+        visit(r->expression);
+        emit(OpCode::Pop);
+    }
+    emit(OpCode::Halt);
+}
@@ -0,0 +1,321 @@
+#include "../include/c_generator.h"
+#include "../include/type_checker.h"
+#include "runtime_source.h"  // RUNTIME_SOURCE, generated from runtime/runtime.c
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+static bool isNumeric(ValueType type) {
+    return type == ValueType::Int || type == ValueType::Float;
+}
+
+static const char* cType(ValueType type) {
+    switch (type) {
+        case ValueType::Int: return "int64_t";
+        case ValueType::Float: return "double";
+        case ValueType::Bool: return "bool";
+        case ValueType::String: return "const char*";
+    }
+    return "int64_t";
+}
+
+static const char* zeroValue(ValueType type) {
+    switch (type) {
+        case ValueType::Int: return "0";
+        case ValueType::Float: return "0.0";
+        case ValueType::Bool: return "false";
+        case ValueType::String: return "\"\"";
+    }
+    return "0";
+}
+
+static std::string stringLiteral(std::string_view text) {
+    std::string out = "\"";
+    for (unsigned char c : text) {
+        // '?' is escaped so that no trigraph can form
+        if (c == '"' || c == '\\' || c == '?') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20 || c >= 0x7f) {
+            char octal[8];
+            std::snprintf(octal, sizeof(octal), "\\%03o", c);
+            out += octal;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out + "\"";
+}
+
+// Truthiness as a C condition
+static std::string truth(const CExpression& value) {
+    switch (value.type) {
+        case ValueType::Int: return "(" + value.code + " != 0)";
+        case ValueType::Float: return "(" + value.code + " != 0.0)";  // NaN is true
+        case ValueType::Bool: return value.code;
+        case ValueType::String: return "(" + value.code + "[0] != '\\0')";
+    }
+    return value.code;
+}
+
+static std::string asString(const CExpression& value) {
+    switch (value.type) {
+        case ValueType::Int: return "rt_int_to_string(" + value.code + ")";
+        case ValueType::Float: return "rt_float_to_string(" + value.code + ")";
+        case ValueType::Bool: return "rt_bool_to_string(" + value.code + ")";
+        case ValueType::String: return value.code;
+    }
+    return value.code;
+}
+
+void CGenerator::generate(ASTNodePtr program, std::ostream& out) {
+    body.str("");
+    variables.clear();
+    indent = 1;
+
+    visit(program);
+
+    out << "/* Generated by the 59LANG compiler (compiler --emit-c) */\n";
+    out << "#include <stdbool.h>\n";
+    out << RUNTIME_SOURCE;
+    out << "\nint main(void) {\n";
+
+    // Every variable starts as its type's zero value (0, 0.0, false, "")
+    std::vector<const Variable*> ordered;
+    for (const auto& entry : variables) ordered.push_back(&entry.second);
+    std::sort(ordered.begin(), ordered.end(), [](const Variable* a, const Variable* b) {
+        return a->order < b->order;
+    });
+    for (const Variable* v : ordered) {
+        out << "    " << cType(v->type) << " " << v->name << " = " << zeroValue(v->type) << ";\n";
+    }
+    if (!ordered.empty()) out << "\n";
+
+    out << body.str();
+    out << "    return 0;\n";
+    out << "}\n";
+}
+
+void CGenerator::line(const std::string& text) {
+    body << std::string(indent * 4, ' ') << text << "\n";
+}
+
+void CGenerator::compileBlock(const ASTNodeList& statements) {
+    ++indent;
+    for (ASTNodePtr stmt : statements) {
+        if (stmt) visit(stmt);
+    }
+    --indent;
+}
+
+std::string CGenerator::condition(ASTNodePtr node) {
+    std::string text = truth(visit(node));
+    // Drop one redundant pair of parentheses: `if ((x != 0))`
+    if (text.size() >= 2 && text.front() == '(' && text.back() == ')') {
+        int depth = 0;
+        bool outer = true;
+        for (size_t i = 0; i + 1 < text.size(); ++i) {
+            if (text[i] == '(') ++depth;
+            else if (text[i] == ')') --depth;
+            if (depth == 0) {
+                outer = false;
+                break;
+            }
+        }
+        if (outer) text = text.substr(1, text.size() - 2);
+    }
+    return text;
+}
+
+// The value converted for storing into a variable of type `to`; the checker
+// only allows core <-> flux conversions
+std::string CGenerator::convert(const CExpression& value, ValueType to) {
+    if (value.type == ValueType::Int && to == ValueType::Float) return "(double)" + value.code;
+    if (value.type == ValueType::Float && to == ValueType::Int) return "rt_float_to_int(" + value.code + ")";
+    return value.code;
+}
+
+const CGenerator::Variable& CGenerator::variableFor(std::string_view name) const {
+    auto it = variables.find(name);
+    if (it == variables.end()) {
+        throw std::runtime_error("Symbol '" + std::string(name) + "' not declared");
+    }
+    return it->second;
+}
+
+CExpression CGenerator::visitNode(ASTNodePtr node) {
+    throw std::runtime_error(std::string("Cannot compile ") + nodeKindToString(node->kind) + " node");
+}
+
+CExpression CGenerator::visitProgram(Program* p) {
+    --indent;  // The program body is main's body
+    compileBlock(p->declarations);
+    compileBlock(p->statements);
+    ++indent;
+    return {};
+}
+
+CExpression CGenerator::visitDeclaration(Declaration* d) {
+    ValueType type = valueTypeFromName(std::string(d->dataType));
+
+    for (size_t i = 0; i < d->identifiers.size(); ++i) {
+        std::string_view name = d->identifiers[i];
+        if (!variables.count(name)) {
+            // Prefixed so that 59LANG names never collide with C keywords or the runtime
+            variables.emplace(name, Variable{"v_" + std::string(name), type, variables.size()});
+        }
+        const Variable& variable = variableFor(name);
+        ASTNodePtr init = i < d->initializers.size() ? d->initializers[i] : nullptr;
+
+        // Re-running a declaration (e.g. inside a loop body) resets the variable
+        std::string value = init ? convert(visit(init), type) : zeroValue(type);
+        line(variable.name + " = " + value + ";");
+    }
+    return {};
+}
+
+CExpression CGenerator::visitAssignment(Assignment* a) {
+    const Variable& variable = variableFor(a->identifier);
+    line(variable.name + " = " + convert(visit(a->expression), variable.type) + ";");
+    return {};
+}
+
+CExpression CGenerator::visitBinaryOp(BinaryOp* b) {
+    std::string op(b->operation);
+    CExpression left = visit(b->left);
+    CExpression right = visit(b->right);
+    ValueType type = checkedType(b);
+
+    // Short-circuit operators test their operands' truthiness
+    if (op == "&&" || op == "||") return {"(" + truth(left) + " " + op + " " + truth(right) + ")", type};
+
+    // String concatenation: either side a string, the other is formatted
+    if (type == ValueType::String) return {"rt_concat(" + asString(left) + ", " + asString(right) + ")", type};
+
+    if (type == ValueType::Int) {
+        const char* helper = op == "+" ? "rt_add" : op == "-" ? "rt_sub" : op == "*" ? "rt_mul" :
+                             op == "/" ? "rt_div" : op == "%" ? "rt_mod" : "rt_pow_int";
+        return {std::string(helper) + "(" + left.code + ", " + right.code + ")", type};
+    }
+    if (type == ValueType::Float) {
+        // Mixed int/float operands are promoted by C's usual conversions
+        if (op == "%") return {"fmod(" + left.code + ", " + right.code + ")", type};
+        if (op == "**") return {"pow(" + left.code + ", " + right.code + ")", type};
+        return {"(" + left.code + " " + op + " " + right.code + ")", type};
+    }
+
+    // Comparisons
+    if (left.type == ValueType::String && right.type == ValueType::String) {
+        return {"(strcmp(" + left.code + ", " + right.code + ") " + op + " 0)", type};
+    }
+    if (left.type == right.type || (isNumeric(left.type) && isNumeric(right.type))) {
+        return {"(" + left.code + " " + op + " " + right.code + ")", type};
+    }
+    // Values of different types are never equal; both sides still run
+    return {"((void)" + left.code + ", (void)" + right.code + ", " + (op == "!=" ? "true" : "false") + ")", type};
+}
+
+CExpression CGenerator::visitUnaryOp(UnaryOp* u) {
+    CExpression operand = visit(u->operand);
+
+    if (u->operation == "!") return {"(!" + truth(operand) + ")", ValueType::Bool};
+    if (checkedType(u) == ValueType::Int) return {"rt_neg(" + operand.code + ")", ValueType::Int};
+    return {"(-" + operand.code + ")", ValueType::Float};
+}
+
+CExpression CGenerator::visitLiteral(Literal* l) {
+    if (l->dataType == "int") {
+        try {
+            int64_t value = std::stoll(std::string(l->value));
+            // -9223372036854775808 is not a valid C constant (its magnitude overflows)
+            if (value == INT64_MIN) return {"INT64_MIN", ValueType::Int};
+            return {"INT64_C(" + std::to_string(value) + ")", ValueType::Int};
+        } catch (const std::out_of_range&) {
+            throw std::runtime_error("Integer literal '" + std::string(l->value) + "' out of range");
+        }
+    }
+    if (l->dataType == "float") {
+        // Round-trips exactly; always spelled as a floating constant
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.17g", std::stod(std::string(l->value)));
+        std::string code = text;
+        if (code.find_first_of(".e") == std::string::npos) code += ".0";
+        return {code, ValueType::Float};
+    }
+    if (l->dataType == "bool") return {l->value == "true" ? "true" : "false", ValueType::Bool};
+
+    return {stringLiteral(l->value), ValueType::String};
+}
+
+CExpression CGenerator::visitIdentifier(Identifier* id) {
+    return {variableFor(id->name).name, checkedType(id)};
+}
+
+CExpression CGenerator::visitFunctionCall(FunctionCall* f) {
+    if (f->functionName == "input") {
+        auto target = nodeAs<Identifier>(f->arguments.empty() ? nullptr : f->arguments[0]);
+        if (!target) throw std::runtime_error("listen expects a variable");
+
+        const Variable& variable = variableFor(target->name);
+        const char* reader = "rt_read_int";
+        switch (variable.type) {
+            case ValueType::Int: reader = "rt_read_int"; break;
+            case ValueType::Float: reader = "rt_read_float"; break;
+            case ValueType::Bool: reader = "rt_read_bool"; break;
+            case ValueType::String: reader = "rt_read_string"; break;
+        }
+        line(variable.name + " = " + reader + "();");
+        return {};
+    }
+
+    CExpression value = visit(f->arguments.at(0));
+    const char* printer = "rt_print_int";
+    switch (value.type) {
+        case ValueType::Int: printer = "rt_print_int"; break;
+        case ValueType::Float: printer = "rt_print_float"; break;
+        case ValueType::Bool: printer = "rt_print_bool"; break;
+        case ValueType::String: printer = "rt_print_string"; break;
+    }
+    line(std::string(printer) + "(" + value.code + ");");
+    return {};
+}
+
+CExpression CGenerator::visitIfStatement(IfStatement* iff) {
+    line("if (" + condition(iff->condition) + ") {");
+    compileBlock(iff->thenBranch);
+    if (!iff->elseBranch.empty()) {
+        line("} else {");
+        compileBlock(iff->elseBranch);
+    }
+    line("}");
+    return {};
+}
+
+CExpression CGenerator::visitWhileLoop(WhileLoop* w) {
+    line("while (" + condition(w->condition) + ") {");
+    compileBlock(w->body);
+    line("}");
+    return {};
+}
+
+CExpression CGenerator::visitForLoop(ForLoop* f) {
+    if (f->initialization) visit(f->initialization);
+
+    line("while (" + condition(f->condition) + ") {");
+    compileBlock(f->body);
+    if (f->increment) {
+        ++indent;
+        line("(void)" + visit(f->increment).code + ";");  // Evaluated and discarded
+        --indent;
+    }
+    line("}");
+    return {};
+}
+
+CExpression CGenerator::visitReturnStatement(ReturnStatement* r) {
+    // `return` ends the program; its value is evaluated and discarded
+    if (r->expression) line("(void)" + visit(r->expression).code + ";");
+    line("return 0;");
+    return {};
+}
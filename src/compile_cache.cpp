@@ -0,0 +1,98 @@
+#include "../include/compile_cache.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+// Multipliers from xxHash64
+static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+
+static uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// Little-endian regardless of the host, so hashes can be stored; compiles
+// to a single load on little-endian targets
+static uint64_t load64(const char* p) {
+    auto b = reinterpret_cast<const unsigned char*>(p);
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | b[i];
+    return v;
+}
+
+static uint64_t mixWord(uint64_t k) {
+    return rotl(k * PRIME2, 31) * PRIME1;
+}
+
+uint64_t hashBytes(std::string_view data, uint64_t seed) {
+    const char* p = data.data();
+    size_t n = data.size();
+    uint64_t h = (seed + PRIME3) ^ (static_cast<uint64_t>(n) * PRIME1);
+
+    for (; n >= 8; p += 8, n -= 8) {
+        h = rotl(h ^ mixWord(load64(p)), 27) * PRIME1 + PRIME2;
+    }
+    if (n > 0) {
+        uint64_t tail = 0;
+        for (size_t i = n; i-- > 0;) tail = (tail << 8) | static_cast<unsigned char>(p[i]);
+        h = rotl(h ^ mixWord(tail), 27) * PRIME1 + PRIME2;
+    }
+
+    // Final avalanche so every input bit reaches every output bit
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+DiskCache::DiskCache(const std::string& dir, std::string_view salt)
+    : directory(dir), seed(hashBytes(salt)) {
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (!fs::is_directory(directory)) {
+        throw std::runtime_error("Cannot create cache directory " + directory +
+                                 (error ? ": " + error.message() : ""));
+    }
+}
+
+std::string DiskCache::entryPath(std::string_view source) const {
+    static const char hex[] = "0123456789abcdef";
+    std::string name;
+    for (uint64_t h : {hashBytes(source, seed), hashBytes(source, ~seed)}) {
+        for (int shift = 60; shift >= 0; shift -= 4) name.push_back(hex[(h >> shift) & 0xF]);
+    }
+    return (fs::path(directory) / name).string();
+}
+
+std::shared_ptr<const SourceBuffer> DiskCache::find(std::string_view source) {
+    std::string ioError;
+    return SourceBuffer::fromFile(entryPath(source), ioError);
+}
+
+void DiskCache::insert(std::string_view source, std::string_view contents) {
+    std::string path = entryPath(source);
+
+    // Unique across threads and processes writing the same entry
+    static std::atomic<uint64_t> counter(0);
+    static const uint64_t processTag = std::random_device()() ^
+        static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::string temporary = path + "." + std::to_string(processTag) + "-" + std::to_string(counter++) + ".tmp";
+
+    std::ofstream out(temporary, std::ios::binary);
+    out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    out.close();
+
+    // Rename replaces any existing entry in one step; readers that already
+    // mapped the old file keep it
+    std::error_code error;
+    if (out) fs::rename(temporary, path, error);
+    if (!out || error) fs::remove(temporary, error);
+}
@@ -0,0 +1,405 @@
+#include "../include/constant_folder.h"
+#include "../include/int_arith.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+// Value of a Literal; unlike Value, owns its string
+struct LiteralValue {
+    ValueType type = ValueType::Int;
+    int64_t i = 0;
+    double f = 0.0;
+    bool b = false;
+    std::string s;
+};
+
+static bool literalConstant(ASTNodePtr node, LiteralValue& c) {
+    auto l = nodeAs<Literal>(node);
+    if (!l) return false;
+
+    try {
+        if (l->dataType == "int") {
+            c.type = ValueType::Int;
+            c.i = std::stoll(std::string(l->value));
+        } else if (l->dataType == "float") {
+            c.type = ValueType::Float;
+            c.f = std::stod(std::string(l->value));
+        } else if (l->dataType == "bool") {
+            c.type = ValueType::Bool;
+            c.b = l->value == "true";
+        } else {
+            c.type = ValueType::String;
+            c.s = std::string(l->value);
+        }
+    } catch (const std::out_of_range&) {
+        return false;  // Reported by the backend
+    }
+    return true;
+}
+
+static bool isNumeric(ValueType type) {
+    return type == ValueType::Int || type == ValueType::Float;
+}
+
+static bool truthy(const LiteralValue& c) {
+    switch (c.type) {
+        case ValueType::Int: return c.i != 0;
+        case ValueType::Float: return c.f != 0.0;
+        case ValueType::Bool: return c.b;
+        case ValueType::String: return !c.s.empty();
+    }
+    return false;
+}
+
+std::optional<bool> literalTruth(ASTNodePtr node) {
+    LiteralValue c;
+    if (!literalConstant(node, c)) return std::nullopt;
+    return truthy(c);
+}
+
+static double toDouble(const LiteralValue& c) {
+    return c.type == ValueType::Int ? static_cast<double>(c.i) : c.f;
+}
+
+// Text of a folded literal; floats round-trip exactly through std::stod
+static std::string literalText(const LiteralValue& c) {
+    switch (c.type) {
+        case ValueType::Int: return std::to_string(c.i);
+        case ValueType::Float: {
+            // Shortest text that reads back as the same double
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), c.f);
+            std::string text(buffer, result.ptr);
+            if (text.find_first_of(".e") == std::string::npos) text += ".0";
+            return text;
+        }
+        case ValueType::Bool: return c.b ? "true" : "false";
+        case ValueType::String: return c.s;
+    }
+    return "";
+}
+
+static const char* literalType(ValueType type) {
+    switch (type) {
+        case ValueType::Int: return "int";
+        case ValueType::Float: return "float";
+        case ValueType::Bool: return "bool";
+        case ValueType::String: return "string";
+    }
+    return "int";
+}
+
+// How broadcast (and string concatenation) prints a value; see valueToString
+static std::string printedText(const LiteralValue& c) {
+    switch (c.type) {
+        case ValueType::Float: {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.15g", c.f);
+            return buffer;
+        }
+        default: return literalText(c);
+    }
+}
+
+template <typename T>
+static bool compare(std::string_view op, const T& a, const T& b) {
+    if (op == "==") return a == b;
+    if (op == "!=") return a != b;
+    if (op == "<") return a < b;
+    if (op == "<=") return a <= b;
+    if (op == ">") return a > b;
+    return a >= b;
+}
+
+// `a op b` as the VM computes it; false where the VM would raise an error
+// or the result has no literal form (inf, nan)
+static bool foldBinary(std::string_view op, const LiteralValue& a, const LiteralValue& b, LiteralValue& result) {
+    if (op == "+" && (a.type == ValueType::String || b.type == ValueType::String)) {
+        result.type = ValueType::String;
+        result.s = printedText(a) + printedText(b);
+        return true;
+    }
+
+    if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%" || op == "**") {
+        if (!isNumeric(a.type) || !isNumeric(b.type)) return false;
+
+        if (a.type == ValueType::Int && b.type == ValueType::Int) {
+            result.type = ValueType::Int;
+            if (op == "+") result.i = wrapAdd(a.i, b.i);
+            else if (op == "-") result.i = wrapSub(a.i, b.i);
+            else if (op == "*") result.i = wrapMul(a.i, b.i);
+            else if (op == "/" || op == "%") {
+                // Division by zero is left for the VM to report
+                if (b.i == 0) return false;
+                result.i = (op == "/") ? wrapDiv(a.i, b.i) : wrapMod(a.i, b.i);
+            } else {
+                if (a.i == 0 && b.i < 0) return false;
+                result.i = intPow(a.i, b.i);
+            }
+            return true;
+        }
+
+        double x = toDouble(a), y = toDouble(b);
+        result.type = ValueType::Float;
+        if (op == "+") result.f = x + y;
+        else if (op == "-") result.f = x - y;
+        else if (op == "*") result.f = x * y;
+        else if (op == "/") result.f = x / y;
+        else if (op == "%") result.f = std::fmod(x, y);
+        else result.f = std::pow(x, y);
+        return std::isfinite(result.f);
+    }
+
+    // Comparisons
+    result.type = ValueType::Bool;
+    if (a.type == ValueType::Int && b.type == ValueType::Int) {
+        result.b = compare(op, a.i, b.i);
+    } else if (isNumeric(a.type) && isNumeric(b.type)) {
+        result.b = compare(op, toDouble(a), toDouble(b));
+    } else if (a.type == ValueType::String && b.type == ValueType::String) {
+        result.b = compare(op, a.s, b.s);
+    } else if (a.type == ValueType::Bool && b.type == ValueType::Bool) {
+        result.b = compare(op, a.b, b.b);
+    } else if (op == "==" || op == "!=") {
+        result.b = (op == "!=");  // Values of different types are never equal
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Literal of the given type whose value is exactly `value` (+0.0 for zero)
+static bool isLiteralNumber(ASTNodePtr node, ValueType type, double value) {
+    LiteralValue c;
+    if (!literalConstant(node, c) || c.type != type) return false;
+    double v = toDouble(c);
+    return v == value && !std::signbit(v);
+}
+
+void ConstantFolder::run(ASTNodePtr program) {
+    variables.clear();
+    folded = 0;
+    simplified = 0;
+    if (program) visit(program);
+}
+
+Literal* ConstantFolder::makeLiteral(const std::string& value, const char* dataType) {
+    auto lit = arena.make<Literal>();
+    lit->value = arena.copyString(value);
+    lit->dataType = dataType;
+    return lit;
+}
+
+void ConstantFolder::foldBlock(ASTNodeList& statements) {
+    for (ASTNodePtr& stmt : statements) {
+        stmt = fold(stmt);
+    }
+}
+
+// Static type of an expression where it is evident without a full type
+// check; identities are only applied when both sides' types are known
+std::optional<ValueType> ConstantFolder::typeOf(ASTNodePtr node) const {
+    if (!node) return std::nullopt;
+
+    switch (node->kind) {
+        case NodeKind::Literal: {
+            std::string_view type = static_cast<Literal*>(node)->dataType;
+            return valueTypeFromName(std::string(type));
+        }
+        case NodeKind::Identifier: {
+            auto it = variables.find(static_cast<Identifier*>(node)->name);
+            if (it == variables.end()) return std::nullopt;
+            return it->second;
+        }
+        case NodeKind::UnaryOp: {
+            auto u = static_cast<UnaryOp*>(node);
+            if (u->operation == "!") return ValueType::Bool;
+            auto operand = typeOf(u->operand);
+            if (operand && isNumeric(*operand)) return operand;
+            return std::nullopt;
+        }
+        case NodeKind::BinaryOp: {
+            auto b = static_cast<BinaryOp*>(node);
+            std::string_view op = b->operation;
+            if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%" || op == "**") {
+                auto left = typeOf(b->left), right = typeOf(b->right);
+                if (!left || !right) return std::nullopt;
+                if (op == "+" && (*left == ValueType::String || *right == ValueType::String)) return ValueType::String;
+                if (!isNumeric(*left) || !isNumeric(*right)) return std::nullopt;
+                return (*left == ValueType::Int && *right == ValueType::Int) ? ValueType::Int : ValueType::Float;
+            }
+            return ValueType::Bool;  // Comparisons and logical operators
+        }
+        default:
+            return std::nullopt;
+    }
+}
+
+// Algebraic identities. Each keeps the surviving operand's evaluation (and
+// so any runtime error in it) and never changes the result's type: x + 0
+// holds for core x only, since -0.0 + 0 is 0.0 for a flux
+ASTNodePtr ConstantFolder::simplify(BinaryOp* b) {
+    std::string_view op = b->operation;
+    auto left = typeOf(b->left), right = typeOf(b->right);
+    bool intLeft = left == ValueType::Int, intRight = right == ValueType::Int;
+    bool numLeft = left && isNumeric(*left), numRight = right && isNumeric(*right);
+    bool floatLeft = left == ValueType::Float, floatRight = right == ValueType::Float;
+
+    auto one = [](ASTNodePtr node, bool isFloat) {
+        return isLiteralNumber(node, ValueType::Int, 1) || (isFloat && isLiteralNumber(node, ValueType::Float, 1));
+    };
+
+    ASTNodePtr result = nullptr;
+    if (op == "+") {
+        if (intLeft && isLiteralNumber(b->right, ValueType::Int, 0)) result = b->left;
+        else if (intRight && isLiteralNumber(b->left, ValueType::Int, 0)) result = b->right;
+    } else if (op == "-") {
+        if (numLeft && (isLiteralNumber(b->right, ValueType::Int, 0) ||
+                        (floatLeft && isLiteralNumber(b->right, ValueType::Float, 0)))) {
+            result = b->left;
+        }
+    } else if (op == "*") {
+        if (numLeft && one(b->right, floatLeft)) result = b->left;
+        else if (numRight && one(b->left, floatRight)) result = b->right;
+        // x * 0 is 0 for a core variable (a flux may be inf or nan)
+        else if (intLeft && nodeAs<Identifier>(b->left) && isLiteralNumber(b->right, ValueType::Int, 0)) result = b->right;
+        else if (intRight && nodeAs<Identifier>(b->right) && isLiteralNumber(b->left, ValueType::Int, 0)) result = b->left;
+    } else if (op == "/" || op == "**") {
+        if (numLeft && one(b->right, floatLeft && op == "/")) result = b->left;
+    }
+
+    if (!result) return b;
+    ++simplified;
+    return result;
+}
+
+ASTNodePtr ConstantFolder::visitProgram(Program* p) {
+    foldBlock(p->declarations);
+    foldBlock(p->statements);
+    return p;
+}
+
+ASTNodePtr ConstantFolder::visitDeclaration(Declaration* d) {
+    ValueType type = valueTypeFromName(std::string(d->dataType));
+    for (ASTNodePtr& init : d->initializers) {
+        init = fold(init);
+    }
+    for (std::string_view name : d->identifiers) {
+        variables[name] = type;
+    }
+    return d;
+}
+
+ASTNodePtr ConstantFolder::visitAssignment(Assignment* a) {
+    a->expression = fold(a->expression);
+    return a;
+}
+
+ASTNodePtr ConstantFolder::visitBinaryOp(BinaryOp* b) {
+    std::string_view op = b->operation;
+    b->left = fold(b->left);
+    b->right = fold(b->right);
+
+    LiteralValue left, right, result;
+    bool leftConstant = literalConstant(b->left, left);
+    bool rightConstant = literalConstant(b->right, right);
+
+    // Short-circuit operators: a constant left side decides whether the
+    // right side runs at all
+    if (op == "&&" || op == "||") {
+        bool isAnd = (op == "&&");
+        if (leftConstant && truthy(left) != isAnd) {
+            ++folded;
+            return makeLiteral(isAnd ? "false" : "true", "bool");
+        }
+        if (leftConstant && rightConstant) {
+            ++folded;
+            return makeLiteral(truthy(right) ? "true" : "false", "bool");
+        }
+        if (leftConstant && typeOf(b->right) == ValueType::Bool) {
+            ++simplified;
+            return b->right;  // true && b, false || b
+        }
+        if (rightConstant && truthy(right) == isAnd && typeOf(b->left) == ValueType::Bool) {
+            ++simplified;
+            return b->left;   // b && true, b || false
+        }
+        return b;
+    }
+
+    if (leftConstant && rightConstant && foldBinary(op, left, right, result)) {
+        ++folded;
+        return makeLiteral(literalText(result), literalType(result.type));
+    }
+    return simplify(b);
+}
+
+ASTNodePtr ConstantFolder::visitUnaryOp(UnaryOp* u) {
+    u->operand = fold(u->operand);
+
+    LiteralValue operand;
+    if (literalConstant(u->operand, operand)) {
+        if (u->operation == "!") {
+            ++folded;
+            return makeLiteral(truthy(operand) ? "false" : "true", "bool");
+        }
+        if (operand.type == ValueType::Int) {
+            operand.i = wrapSub(0, operand.i);
+        } else if (operand.type == ValueType::Float) {
+            operand.f = -operand.f;
+        } else {
+            return u;  // Type error; reported by the backend
+        }
+        ++folded;
+        return makeLiteral(literalText(operand), literalType(operand.type));
+    }
+
+    // void void b and - -x cancel out when the type is unchanged
+    auto inner = nodeAs<UnaryOp>(u->operand);
+    if (inner && inner->operation == u->operation) {
+        auto type = typeOf(inner->operand);
+        bool cancels = (u->operation == "!") ? type == ValueType::Bool : (type && isNumeric(*type));
+        if (cancels) {
+            ++simplified;
+            return inner->operand;
+        }
+    }
+    return u;
+}
+
+ASTNodePtr ConstantFolder::visitFunctionCall(FunctionCall* f) {
+    // listen's argument is the target variable, not an expression
+    if (f->functionName != "input") {
+        for (ASTNodePtr& argument : f->arguments) {
+            argument = fold(argument);
+        }
+    }
+    return f;
+}
+
+ASTNodePtr ConstantFolder::visitIfStatement(IfStatement* iff) {
+    iff->condition = fold(iff->condition);
+    foldBlock(iff->thenBranch);
+    foldBlock(iff->elseBranch);
+    return iff;
+}
+
+ASTNodePtr ConstantFolder::visitWhileLoop(WhileLoop* w) {
+    w->condition = fold(w->condition);
+    foldBlock(w->body);
+    return w;
+}
+
+ASTNodePtr ConstantFolder::visitForLoop(ForLoop* f) {
+    f->initialization = fold(f->initialization);
+    f->condition = fold(f->condition);
+    f->increment = fold(f->increment);
+    foldBlock(f->body);
+    return f;
+}
+
+ASTNodePtr ConstantFolder::visitReturnStatement(ReturnStatement* r) {
+    r->expression = fold(r->expression);
+    return r;
+}
@@ -0,0 +1,277 @@
+#include "../include/dead_code.h"
+#include "../include/constant_folder.h"
+#include "../include/int_arith.h"
+#include <cstdlib>
+#include <stdexcept>
+
+static bool isNumeric(ValueType type) {
+    return type == ValueType::Int || type == ValueType::Float;
+}
+
+// listen's argument is the variable it writes, not a read
+static bool isListen(ASTNodePtr node) {
+    auto call = nodeAs<FunctionCall>(node);
+    return call && call->functionName == "input";
+}
+
+static void collectReads(ASTNodePtr node, std::unordered_set<std::string_view>& reads,
+                         std::unordered_set<std::string_view>& listened) {
+    if (auto id = nodeAs<Identifier>(node)) {
+        reads.insert(id->name);
+        return;
+    }
+    if (isListen(node)) {
+        for (ASTNodePtr argument : static_cast<FunctionCall*>(node)->arguments) {
+            if (auto id = nodeAs<Identifier>(argument)) listened.insert(id->name);
+        }
+        return;
+    }
+    forEachChild(node, [&](ASTNodePtr child) { collectReads(child, reads, listened); });
+}
+
+static void collectDeclarations(ASTNodePtr node, std::unordered_map<std::string_view, ValueType>& variables) {
+    if (auto d = nodeAs<Declaration>(node)) {
+        ValueType type = valueTypeFromName(std::string(d->dataType));
+        for (std::string_view name : d->identifiers) variables[name] = type;
+    }
+    forEachChild(node, [&variables](ASTNodePtr child) { collectDeclarations(child, variables); });
+}
+
+void DeadCodeEliminator::run(ASTNodePtr program) {
+    branches = 0;
+    unreachable = 0;
+    removedVariables = 0;
+    removedNames.clear();
+
+    auto p = nodeAs<Program>(program);
+    if (!p) return;
+
+    variables.clear();
+    hoisted.clear();
+    collectDeclarations(p, variables);
+
+    pruneBlock(p->declarations);
+    pruneBlock(p->statements);
+    p->declarations.insert(p->declarations.end(), hoisted.begin(), hoisted.end());
+
+    // Removing `a = b;` can leave b unread in turn
+    while (removeDeadVariables(p)) {}
+}
+
+// Remove code that never runs, keeping the declarations inside it
+void DeadCodeEliminator::drop(ASTNodePtr node) {
+    if (!node) return;
+    if (auto d = nodeAs<Declaration>(node)) {
+        d->initializers.clear();
+        hoisted.push_back(d);
+        return;
+    }
+    forEachChild(node, [this](ASTNodePtr child) { drop(child); });
+}
+
+void DeadCodeEliminator::pruneBlock(ASTNodeList& statements) {
+    ASTNodeList kept(statements.get_allocator());
+    bool returned = false;
+
+    // Appends a statement, splicing in the pruned body of constant branches
+    auto keep = [&](auto& self, ASTNodePtr stmt) -> void {
+        if (!stmt) return;
+        if (returned) {
+            ++unreachable;
+            drop(stmt);
+            return;
+        }
+
+        if (auto iff = nodeAs<IfStatement>(stmt)) {
+            if (auto truth = literalTruth(iff->condition)) {
+                ++branches;
+                ASTNodeList& taken = *truth ? iff->thenBranch : iff->elseBranch;
+                for (ASTNodePtr s : (*truth ? iff->elseBranch : iff->thenBranch)) drop(s);
+                for (ASTNodePtr s : taken) self(self, s);
+                return;
+            }
+            pruneBlock(iff->thenBranch);
+            pruneBlock(iff->elseBranch);
+        } else if (auto w = nodeAs<WhileLoop>(stmt)) {
+            if (literalTruth(w->condition) == false) {
+                ++branches;
+                drop(w);
+                return;
+            }
+            pruneBlock(w->body);
+        } else if (auto f = nodeAs<ForLoop>(stmt)) {
+            if (literalTruth(f->condition) == false) {
+                ++branches;
+                for (ASTNodePtr s : f->body) drop(s);
+                self(self, f->initialization);
+                return;
+            }
+            pruneBlock(f->body);
+        }
+
+        kept.push_back(stmt);
+        if (stmt->kind == NodeKind::ReturnStatement) returned = true;
+    };
+
+    for (ASTNodePtr stmt : statements) keep(keep, stmt);
+    statements.swap(kept);
+}
+
+// Value of an int literal, if `node` is one that fits
+static std::optional<int64_t> intLiteral(ASTNodePtr node) {
+    auto l = nodeAs<Literal>(node);
+    if (!l || l->dataType != "int") return std::nullopt;
+    try {
+        return std::stoll(std::string(l->value));
+    } catch (const std::out_of_range&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<ValueType> safeType(ASTNodePtr expression,
+                                  const std::unordered_map<std::string_view, ValueType>& variables) {
+    if (!expression) return std::nullopt;
+
+    switch (expression->kind) {
+        case NodeKind::Literal: {
+            auto l = static_cast<Literal*>(expression);
+            if (l->dataType == "int" && !intLiteral(l)) return std::nullopt;
+            return valueTypeFromName(std::string(l->dataType));
+        }
+        case NodeKind::Identifier: {
+            auto it = variables.find(static_cast<Identifier*>(expression)->name);
+            if (it == variables.end()) return std::nullopt;
+            return it->second;
+        }
+        case NodeKind::UnaryOp: {
+            auto u = static_cast<UnaryOp*>(expression);
+            auto operand = safeType(u->operand, variables);
+            if (!operand) return std::nullopt;
+            if (u->operation == "!") return ValueType::Bool;
+            if (isNumeric(*operand)) return operand;
+            return std::nullopt;
+        }
+        case NodeKind::BinaryOp: {
+            auto b = static_cast<BinaryOp*>(expression);
+            std::string_view op = b->operation;
+            auto left = safeType(b->left, variables), right = safeType(b->right, variables);
+            if (!left || !right) return std::nullopt;
+
+            if (op == "&&" || op == "||") return ValueType::Bool;
+            if (op == "+" && (*left == ValueType::String || *right == ValueType::String)) return ValueType::String;
+
+            bool bothInt = *left == ValueType::Int && *right == ValueType::Int;
+            bool bothNumeric = isNumeric(*left) && isNumeric(*right);
+            if (op == "+" || op == "-" || op == "*") {
+                if (!bothNumeric) return std::nullopt;
+                return bothInt ? ValueType::Int : ValueType::Float;
+            }
+            if (op == "/" || op == "%" || op == "**") {
+                if (!bothNumeric) return std::nullopt;
+                if (!bothInt) return ValueType::Float;  // Flux arithmetic never fails
+
+                // core / 0, core % 0 and 0 ** -n do; a constant divisor or
+                // exponent rules them out
+                auto divisor = intLiteral(b->right);
+                if (op == "**" ? divisor && *divisor >= 0 : divisor && *divisor != 0) return ValueType::Int;
+                return std::nullopt;
+            }
+
+            // Comparisons
+            if (bothNumeric || *left == *right || op == "==" || op == "!=") return ValueType::Bool;
+            return std::nullopt;
+        }
+        default:
+            return std::nullopt;
+    }
+}
+
+// Storing `expression` into a `target` variable cannot fail
+bool DeadCodeEliminator::safeStore(ASTNodePtr expression, ValueType target) const {
+    auto type = safeType(expression, variables);
+    if (!type) return false;
+    if (*type == target) return true;
+    if (*type == ValueType::Int && target == ValueType::Float) return true;
+    // flux -> core fails outside the int range; a literal can be checked
+    auto literal = nodeAs<Literal>(expression);
+    return *type == ValueType::Float && target == ValueType::Int && literal &&
+           fitsInt64(std::strtod(std::string(literal->value).c_str(), nullptr));
+}
+
+static void collectWrites(ASTNodePtr node, std::unordered_map<std::string_view, std::vector<ASTNodePtr>>& writes) {
+    if (auto a = nodeAs<Assignment>(node)) {
+        writes[a->identifier].push_back(a->expression);
+    } else if (auto d = nodeAs<Declaration>(node)) {
+        for (size_t i = 0; i < d->identifiers.size(); ++i) {
+            ASTNodePtr init = i < d->initializers.size() ? d->initializers[i] : nullptr;
+            if (init) writes[d->identifiers[i]].push_back(init);
+        }
+    }
+    forEachChild(node, [&writes](ASTNodePtr child) { collectWrites(child, writes); });
+}
+
+bool DeadCodeEliminator::removeDeadVariables(Program* program) {
+    std::unordered_set<std::string_view> reads, listened;
+    collectReads(program, reads, listened);
+
+    std::unordered_map<std::string_view, std::vector<ASTNodePtr>> writes;
+    collectWrites(program, writes);
+
+    std::unordered_set<std::string_view> dead;
+    for (const auto& [name, type] : variables) {
+        if (reads.count(name) || listened.count(name)) continue;
+
+        bool removable = true;
+        for (ASTNodePtr value : writes[name]) {
+            if (!safeStore(value, type)) {
+                removable = false;
+                break;
+            }
+        }
+        if (removable) dead.insert(name);
+    }
+    if (dead.empty()) return false;
+
+    removeWrites(program->declarations, dead);
+    removeWrites(program->statements, dead);
+    for (std::string_view name : dead) variables.erase(name);
+    removedNames.insert(removedNames.end(), dead.begin(), dead.end());
+    removedVariables += dead.size();
+    return true;
+}
+
+void DeadCodeEliminator::removeWrites(ASTNodeList& statements, const std::unordered_set<std::string_view>& dead) {
+    ASTNodeList kept(statements.get_allocator());
+
+    for (ASTNodePtr stmt : statements) {
+        if (!stmt) continue;
+
+        if (auto a = nodeAs<Assignment>(stmt)) {
+            if (dead.count(a->identifier)) continue;
+        } else if (auto d = nodeAs<Declaration>(stmt)) {
+            // Compact both lists; initializers may be shorter (missing = none)
+            size_t out = 0;
+            for (size_t i = 0; i < d->identifiers.size(); ++i) {
+                if (dead.count(d->identifiers[i])) continue;
+                ASTNodePtr init = i < d->initializers.size() ? d->initializers[i] : nullptr;
+                d->identifiers[out] = d->identifiers[i];
+                if (out < d->initializers.size()) d->initializers[out] = init;
+                ++out;
+            }
+            d->identifiers.resize(out);
+            if (d->initializers.size() > out) d->initializers.resize(out);
+            if (out == 0) continue;
+        } else if (auto iff = nodeAs<IfStatement>(stmt)) {
+            removeWrites(iff->thenBranch, dead);
+            removeWrites(iff->elseBranch, dead);
+        } else if (auto w = nodeAs<WhileLoop>(stmt)) {
+            removeWrites(w->body, dead);
+        } else if (auto f = nodeAs<ForLoop>(stmt)) {
+            auto init = nodeAs<Assignment>(f->initialization);
+            if (init && dead.count(init->identifier)) f->initialization = nullptr;
+            removeWrites(f->body, dead);
+        }
+        kept.push_back(stmt);
+    }
+    statements.swap(kept);
+}
@@ -0,0 +1,261 @@
+#include "../include/driver.h"
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+
+// Writes the AST as JSON (recursive tree of {label, children} objects;
+// expressions also carry their checked "type")
+class AstJsonWriter : public ASTVisitor<AstJsonWriter> {
+public:
+    explicit AstJsonWriter(JsonWriter& j) : json(j) {}
+    
+    void build(ASTNodePtr n) {
+        json.beginObject();
+        if (n) {
+            visit(n);
+        } else {
+            json.key("label").value("<null>");
+        }
+        json.endObject();
+    }
+    
+    void visitNode(ASTNodePtr) {}
+    
+    void visitProgram(Program* p) {
+        beginNode(p, "PROGRAM");
+        for (auto& decl : p->declarations) build(decl);
+        for (auto& stmt : p->statements) build(stmt);
+        endNode();
+    }
+    
+    void visitDeclaration(Declaration* d) {
+        beginNode(d, "DECL");
+        for (size_t i = 0; i < d->identifiers.size(); ++i) {
+            json.beginObject();
+            json.key("label").value("VAR_DECL(" + std::string(d->dataType) + " " + std::string(d->identifiers[i]) + ")");
+            if (i < d->initializers.size() && d->initializers[i] != nullptr) {
+                json.key("children").beginArray();
+                build(d->initializers[i]);
+                json.endArray();
+            }
+            json.endObject();
+        }
+        endNode();
+    }
+    
+    void visitAssignment(Assignment* a) {
+        beginNode(a, "ASSIGN(" + std::string(a->identifier) + ")");
+        if (a->expression) build(a->expression);
+        endNode();
+    }
+    
+    void visitBinaryOp(BinaryOp* b) {
+        beginNode(b, "EXPR(" + std::string(b->operation) + ")");
+        if (b->left) build(b->left);
+        if (b->right) build(b->right);
+        endNode();
+    }
+    
+    void visitUnaryOp(UnaryOp* u) {
+        beginNode(u, "UNARY(" + std::string(u->operation) + ")");
+        if (u->operand) build(u->operand);
+        endNode();
+    }
+    
+    void visitLiteral(Literal* l) {
+        label(l, l->value);
+    }
+    
+    void visitIdentifier(Identifier* id) {
+        label(id, id->name);
+    }
+    
+    void visitFunctionCall(FunctionCall* f) {
+        beginNode(f, "CALL(" + std::string(f->functionName) + ")");
+        for (auto& a : f->arguments) build(a);
+        endNode();
+    }
+    
+    void visitIfStatement(IfStatement* iff) {
+        beginNode(iff, "IF");
+        if (iff->condition) build(iff->condition);
+        block("THEN", iff->thenBranch);
+        if (!iff->elseBranch.empty()) {
+            block("ELSE", iff->elseBranch);
+        }
+        endNode();
+    }
+    
+    void visitWhileLoop(WhileLoop* w) {
+        beginNode(w, "WHILE");
+        if (w->condition) build(w->condition);
+        block("BODY", w->body);
+        endNode();
+    }
+    
+    void visitForLoop(ForLoop* f) {
+        beginNode(f, "FOR");
+        if (f->initialization) build(f->initialization);
+        if (f->condition) build(f->condition);
+        if (f->increment) build(f->increment);
+        block("BODY", f->body);
+        endNode();
+    }
+    
+    void visitReturnStatement(ReturnStatement* r) {
+        beginNode(r, "RETURN");
+        if (r->expression) build(r->expression);
+        endNode();
+    }
+    
+    void visitFunction(Function* fn) {
+        beginNode(fn, "FUNC(" + std::string(fn->name) + ")");
+        for (auto& p : fn->parameters) build(p);
+        for (auto& s : fn->body) build(s);
+        endNode();
+    }
+    
+private:
+    JsonWriter& json;
+    
+    void label(ASTNodePtr n, std::string_view text) {
+        json.key("label").value(text);
+        if (n->valueType) json.key("type").value(valueTypeToString(*n->valueType));  // Typed expressions
+    }
+    
+    // Label followed by the children array; the caller writes the children
+    void beginNode(ASTNodePtr n, std::string_view text) {
+        label(n, text);
+        json.key("children").beginArray();
+    }
+    
+    void endNode() {
+        json.endArray();
+    }
+    
+    void block(const char* text, const ASTNodeList& statements) {
+        json.beginObject();
+        json.key("label").value(text).key("children").beginArray();
+        for (auto& s : statements) build(s);
+        json.endArray();
+        json.endObject();
+    }
+};
+
+void writeAst(JsonWriter& json, ASTNodePtr node) {
+    AstJsonWriter(json).build(node);
+}
+
+void writeErrors(JsonWriter& json, const std::vector<std::shared_ptr<Error>>& errors) {
+    json.beginArray();
+    for (const auto& err : errors) {
+        json.beginObject();
+        json.key("message").value(err->message);
+        json.key("line").value(err->line);
+        json.key("column").value(err->column);
+        json.key("type").value(err->typeToString());
+        json.endObject();
+    }
+    json.endArray();
+}
+
+void writeTokens(JsonWriter& json, const std::vector<Token>& tokens) {
+    json.beginArray();
+    for (const auto& t : tokens) {
+        json.beginObject();
+        json.key("type").value(t.typeToString());
+        json.key("value").value(t.value);
+        json.key("line").value(t.line);
+        json.key("column").value(t.column);
+        json.endObject();
+    }
+    json.endArray();
+}
+
+// Symbols keyed by name, in name order
+void writeSymbolTable(JsonWriter& json, const SymbolTable& table) {
+    std::vector<const Symbol*> symbols;
+    for (const auto& pair : table.getAllSymbols()) symbols.push_back(pair.second.get());
+    std::sort(symbols.begin(), symbols.end(), [](const Symbol* a, const Symbol* b) { return a->name < b->name; });
+    
+    json.beginObject();
+    for (const Symbol* symbol : symbols) {
+        json.key(symbol->name).beginObject();
+        json.key("name").value(symbol->name);
+        json.key("type").value(symbol->type);
+        json.key("line").value(symbol->line);
+        json.key("column").value(symbol->column);
+        json.endObject();
+    }
+    json.endObject();
+}
+
+void writeOptimizerStats(JsonWriter& json, const OptimizerStats& stats) {
+    json.beginObject();
+    json.key("nodesBefore").value(static_cast<uint64_t>(stats.nodesBefore));
+    json.key("nodesAfter").value(static_cast<uint64_t>(stats.nodesAfter));
+    json.key("folded").value(static_cast<uint64_t>(stats.folded));
+    json.key("simplified").value(static_cast<uint64_t>(stats.simplified));
+    json.key("branches").value(static_cast<uint64_t>(stats.branches));
+    json.key("unreachable").value(static_cast<uint64_t>(stats.unreachable));
+    json.key("variables").value(static_cast<uint64_t>(stats.variables));
+    json.key("hoisted").value(static_cast<uint64_t>(stats.hoisted));
+    json.endObject();
+}
+
+unsigned parseEmitSections(const std::string& list) {
+    unsigned emit = 0;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string name = list.substr(start, end - start);
+        start = end + 1;
+        
+        if (name == "errors") emit |= EMIT_ERRORS;
+        else if (name == "symbols") emit |= EMIT_SYMBOLS;
+        else if (name == "tokens") emit |= EMIT_TOKENS;
+        else if (name == "ast") emit |= EMIT_AST;
+        else if (!name.empty()) throw std::runtime_error("Unknown output section '" + name + "'");
+    }
+    return emit;
+}
+
+bool writeCompileResult(JsonWriter& json, std::shared_ptr<const SourceBuffer> source, bool optimizeAst,
+                        unsigned emit) {
+    Parser parser(std::move(source), (emit & EMIT_TOKENS) != 0);
+    ASTNodePtr ast = parser.parse();
+    bool hasErrors = parser.hasErrors();
+    
+    // Optimize before anything is written, so the symbol table matches the
+    // AST; without either section the optimizer does not run
+    std::optional<OptimizerStats> stats;
+    if (optimizeAst && !hasErrors && (emit & (EMIT_AST | EMIT_SYMBOLS))) {
+        stats = optimize(ast, parser.getArena(), &parser.getSymbolTable());
+    }
+    
+    // Diagnostics first, so a reader can stop before the token stream and AST
+    json.key("hasErrors").value(hasErrors);
+    json.key("errorCount").value(static_cast<uint64_t>(parser.getErrors().size()));
+    if (emit & EMIT_ERRORS) {
+        json.key("errors");
+        writeErrors(json, parser.getErrors());
+    }
+    if (emit & EMIT_SYMBOLS) {
+        json.key("symbolTable");
+        writeSymbolTable(json, parser.getSymbolTable());
+    }
+    if (emit & EMIT_TOKENS) {
+        json.key("tokens");
+        writeTokens(json, parser.getTokens());
+    }
+    if (emit & EMIT_AST) {
+        if (stats) {
+            json.key("optimizer");
+            writeOptimizerStats(json, *stats);
+        }
+        json.key("ast");
+        writeAst(json, ast);
+    }
+    return hasErrors;
+}
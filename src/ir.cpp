@@ -0,0 +1,136 @@
+#include "../include/ir.h"
+
+const char* irOpToString(IROp op) {
+    switch (op) {
+        case IROp::Const: return "const";
+        case IROp::Phi: return "phi";
+        case IROp::Add: return "add";
+        case IROp::Sub: return "sub";
+        case IROp::Mul: return "mul";
+        case IROp::Div: return "div";
+        case IROp::Mod: return "mod";
+        case IROp::Pow: return "pow";
+        case IROp::Neg: return "neg";
+        case IROp::Not: return "not";
+        case IROp::Equal: return "eq";
+        case IROp::NotEqual: return "ne";
+        case IROp::Less: return "lt";
+        case IROp::LessEqual: return "le";
+        case IROp::Greater: return "gt";
+        case IROp::GreaterEqual: return "ge";
+        case IROp::ToFloat: return "tofloat";
+        case IROp::ToInt: return "toint";
+        case IROp::ToBool: return "tobool";
+        case IROp::ToString: return "tostring";
+        case IROp::Concat: return "concat";
+        case IROp::Read: return "read";
+        case IROp::Print: return "print";
+        case IROp::Jump: return "jump";
+        case IROp::Branch: return "branch";
+        case IROp::Return: return "ret";
+    }
+    return "?";
+}
+
+bool IRInstruction::definesValue() const {
+    return op != IROp::Print && !isTerminator();
+}
+
+IRInstruction* BasicBlock::terminator() const {
+    if (instructions.empty() || !instructions.back()->isTerminator()) return nullptr;
+    return instructions.back();
+}
+
+BasicBlock* IRProgram::newBlock() {
+    blocks.push_back(std::make_unique<BasicBlock>(static_cast<int>(blocks.size())));
+    return blocks.back().get();
+}
+
+IRInstruction* IRProgram::newInstruction(IROp op, ValueType type) {
+    instructions.emplace_back(op, type);
+    return &instructions.back();
+}
+
+static std::string quoted(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default: out += c;
+        }
+    }
+    return out + "\"";
+}
+
+static std::string valueName(const IRInstruction* value) {
+    return "%" + std::to_string(value->id);
+}
+
+static std::string blockName(const BasicBlock* block) {
+    return "bb" + std::to_string(block->id);
+}
+
+void dumpIR(const IRProgram& program, std::ostream& out) {
+    size_t instructionCount = 0, phiCount = 0;
+    for (const auto& block : program.blocks) {
+        instructionCount += block->instructions.size();
+        for (const IRInstruction* ins : block->instructions) {
+            if (ins->op == IROp::Phi) ++phiCount;
+        }
+    }
+    out << "; " << program.blocks.size() << " blocks, " << instructionCount << " instructions, "
+        << phiCount << " phis\n";
+
+    for (const auto& block : program.blocks) {
+        std::string header = blockName(block.get()) + ":";
+        if (!block->predecessors.empty()) {
+            header.resize(40, ' ');
+            header += "; preds";
+            for (size_t i = 0; i < block->predecessors.size(); ++i) {
+                header += (i ? ", " : " ") + blockName(block->predecessors[i]);
+            }
+        }
+        out << "\n" << header << "\n";
+
+        for (const IRInstruction* ins : block->instructions) {
+            std::string line = "    ";
+            if (ins->definesValue()) {
+                line += valueName(ins) + " = " + irOpToString(ins->op) + " " + valueTypeToString(ins->type);
+            } else {
+                line += irOpToString(ins->op);
+            }
+
+            switch (ins->op) {
+                case IROp::Const:
+                    line += " " + (ins->type == ValueType::String ? quoted(*ins->constant.s) : valueToString(ins->constant));
+                    break;
+                case IROp::Phi:
+                    for (size_t i = 0; i < ins->operands.size(); ++i) {
+                        line += (i ? ", [" : " [") + valueName(ins->operands[i]) + ", " +
+                                blockName(block->predecessors[i]) + "]";
+                    }
+                    break;
+                case IROp::Jump:
+                    line += " " + blockName(block->successors[0]);
+                    break;
+                case IROp::Branch:
+                    line += " " + valueName(ins->operands[0]) + ", " + blockName(block->successors[0]) + ", " +
+                            blockName(block->successors[1]);
+                    break;
+                default:
+                    for (size_t i = 0; i < ins->operands.size(); ++i) {
+                        line += (i ? ", " : " ") + valueName(ins->operands[i]);
+                    }
+            }
+
+            if (!ins->variable.empty()) {
+                if (line.size() < 40) line.resize(40, ' ');
+                line += " ; " + std::string(ins->variable);
+            }
+            out << line << "\n";
+        }
+    }
+}
@@ -0,0 +1,469 @@
+#include "../include/ir_builder.h"
+#include "../include/type_checker.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+static bool isNumeric(ValueType type) {
+    return type == ValueType::Int || type == ValueType::Float;
+}
+
+static IRInstruction* resolve(IRInstruction* value) {
+    while (value->replacement) value = value->replacement;
+    return value;
+}
+
+static void collectDeclarations(ASTNodePtr node, std::unordered_map<std::string_view, ValueType>& variables,
+                                std::vector<std::string_view>& order) {
+    if (auto d = nodeAs<Declaration>(node)) {
+        ValueType type = valueTypeFromName(std::string(d->dataType));
+        for (std::string_view name : d->identifiers) {
+            if (variables.emplace(name, type).second) order.push_back(name);
+        }
+    }
+    forEachChild(node, [&](ASTNodePtr child) { collectDeclarations(child, variables, order); });
+}
+
+IRProgram IRBuilder::build(ASTNodePtr program) {
+    ir = IRProgram();
+    variables.clear();
+    definitions.clear();
+    incompletePhis.clear();
+
+    current = newBlock();
+    sealBlock(current);
+
+    // Every variable starts as its type's zero value, wherever it is declared
+    std::vector<std::string_view> order;
+    collectDeclarations(program, variables, order);
+    for (std::string_view name : order) {
+        writeVariable(name, current, zero(variables[name]));
+    }
+
+    visit(program);
+    if (current) emit(IROp::Return, ValueType::Int);
+
+    finish();
+    return std::move(ir);
+}
+
+BasicBlock* IRBuilder::newBlock() {
+    definitions.emplace_back();
+    incompletePhis.emplace_back();
+    return ir.newBlock();
+}
+
+IRInstruction* IRBuilder::emit(IROp op, ValueType type, std::vector<IRInstruction*> operands) {
+    IRInstruction* ins = ir.newInstruction(op, type);
+    ins->operands = std::move(operands);
+    ins->block = current;
+    current->instructions.push_back(ins);
+    return ins;
+}
+
+IRInstruction* IRBuilder::constant(Value value) {
+    IRInstruction* ins = emit(IROp::Const, value.type);
+    ins->constant = value;
+    return ins;
+}
+
+IRInstruction* IRBuilder::zero(ValueType type) {
+    switch (type) {
+        case ValueType::Int: return constant(Value::ofInt(0));
+        case ValueType::Float: return constant(Value::ofFloat(0.0));
+        case ValueType::Bool: return constant(Value::ofBool(false));
+        case ValueType::String:
+            ir.strings.emplace_back();
+            return constant(Value::ofString(&ir.strings.back()));
+    }
+    return constant(Value::ofInt(0));
+}
+
+void IRBuilder::addEdge(BasicBlock* from, BasicBlock* to) {
+    from->successors.push_back(to);
+    to->predecessors.push_back(from);
+}
+
+void IRBuilder::jump(BasicBlock* target) {
+    emit(IROp::Jump, ValueType::Int);
+    addEdge(current, target);
+}
+
+void IRBuilder::branch(IRInstruction* condition, BasicBlock* whenTrue, BasicBlock* whenFalse) {
+    emit(IROp::Branch, ValueType::Int, {toBool(condition)});
+    addEdge(current, whenTrue);
+    addEdge(current, whenFalse);
+}
+
+void IRBuilder::lowerBlock(const ASTNodeList& statements) {
+    for (ASTNodePtr stmt : statements) {
+        if (!current) return;  // Unreachable after a return
+        if (stmt) visit(stmt);
+    }
+}
+
+IRInstruction* IRBuilder::toBool(IRInstruction* value) {
+    return value->type == ValueType::Bool ? value : emit(IROp::ToBool, ValueType::Bool, {value});
+}
+
+IRInstruction* IRBuilder::toFloat(IRInstruction* value) {
+    return value->type == ValueType::Int ? emit(IROp::ToFloat, ValueType::Float, {value}) : value;
+}
+
+// The value converted for storing into a variable of type `to`; the checker
+// only allows core <-> flux conversions
+IRInstruction* IRBuilder::convert(IRInstruction* value, ValueType to) {
+    if (value->type == ValueType::Int && to == ValueType::Float) return emit(IROp::ToFloat, to, {value});
+    if (value->type == ValueType::Float && to == ValueType::Int) return emit(IROp::ToInt, to, {value});
+    return value;
+}
+
+ValueType IRBuilder::typeOf(std::string_view name) const {
+    auto it = variables.find(name);
+    if (it == variables.end()) {
+        throw std::runtime_error("Symbol '" + std::string(name) + "' not declared");
+    }
+    return it->second;
+}
+
+// ---- SSA construction (Braun et al., algorithms 1-4) ----
+
+void IRBuilder::writeVariable(std::string_view name, BasicBlock* block, IRInstruction* value) {
+    definitions[block->id][name] = value;
+}
+
+IRInstruction* IRBuilder::readVariable(std::string_view name, BasicBlock* block) {
+    auto it = definitions[block->id].find(name);
+    if (it != definitions[block->id].end()) return resolve(it->second);
+    return readVariableRecursive(name, block);
+}
+
+IRInstruction* IRBuilder::readVariableRecursive(std::string_view name, BasicBlock* block) {
+    IRInstruction* value;
+    if (!block->sealed) {
+        // Not all predecessors are known yet: fill in the phi when sealing
+        value = newPhi(name, block);
+        incompletePhis[block->id].emplace_back(name, value);
+    } else if (block->predecessors.size() == 1) {
+        value = readVariable(name, block->predecessors[0]);
+    } else {
+        // Break cycles through loops with an operandless phi first
+        IRInstruction* phi = newPhi(name, block);
+        writeVariable(name, block, phi);
+        value = addPhiOperands(name, phi);
+    }
+    writeVariable(name, block, value);
+    return value;
+}
+
+IRInstruction* IRBuilder::newPhi(std::string_view name, BasicBlock* block) {
+    IRInstruction* phi = ir.newInstruction(IROp::Phi, typeOf(name));
+    phi->variable = name;
+    phi->block = block;
+
+    auto firstNonPhi = std::find_if(block->instructions.begin(), block->instructions.end(),
+                                    [](IRInstruction* ins) { return ins->op != IROp::Phi; });
+    block->instructions.insert(firstNonPhi, phi);
+    return phi;
+}
+
+IRInstruction* IRBuilder::addPhiOperands(std::string_view name, IRInstruction* phi) {
+    for (BasicBlock* pred : phi->block->predecessors) {
+        phi->operands.push_back(readVariable(name, pred));
+    }
+    return tryRemoveTrivialPhi(phi);
+}
+
+// A phi whose operands are all the same value (or the phi itself) is that value
+IRInstruction* IRBuilder::tryRemoveTrivialPhi(IRInstruction* phi) {
+    IRInstruction* same = nullptr;
+    for (IRInstruction* operand : phi->operands) {
+        operand = resolve(operand);
+        if (operand == same || operand == phi) continue;
+        if (same) return phi;  // Merges at least two values
+        same = operand;
+    }
+    if (!same) throw std::runtime_error("Variable '" + std::string(phi->variable) + "' read before definition");
+
+    phi->replacement = same;
+    auto& instructions = phi->block->instructions;
+    instructions.erase(std::find(instructions.begin(), instructions.end(), phi));
+    return same;
+}
+
+void IRBuilder::sealBlock(BasicBlock* block) {
+    for (auto& [name, phi] : incompletePhis[block->id]) {
+        addPhiOperands(name, phi);
+    }
+    incompletePhis[block->id].clear();
+    block->sealed = true;
+}
+
+// Remove phis made trivial by later removals, point every operand at its
+// final value, drop blocks that cannot be reached, and number what is left
+// in reverse postorder
+void IRBuilder::finish() {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto& block : ir.blocks) {
+            std::vector<IRInstruction*> phis;
+            for (IRInstruction* ins : block->instructions) {
+                if (ins->op == IROp::Phi) phis.push_back(ins);
+            }
+            for (IRInstruction* phi : phis) {
+                if (tryRemoveTrivialPhi(phi) != phi) changed = true;
+            }
+        }
+    }
+
+    for (auto& block : ir.blocks) {
+        for (IRInstruction* ins : block->instructions) {
+            for (IRInstruction*& operand : ins->operands) operand = resolve(operand);
+        }
+    }
+
+    std::vector<BasicBlock*> postorder;
+    std::vector<bool> visited(ir.blocks.size(), false);
+    std::function<void(BasicBlock*)> walk = [&](BasicBlock* block) {
+        visited[block->id] = true;
+        // Last successor first, so that reversed, a branch's true side leads
+        for (auto it = block->successors.rbegin(); it != block->successors.rend(); ++it) {
+            if (!visited[(*it)->id]) walk(*it);
+        }
+        postorder.push_back(block);
+    };
+    walk(ir.blocks[0].get());
+
+    std::vector<std::unique_ptr<BasicBlock>> ordered;
+    for (auto it = postorder.rbegin(); it != postorder.rend(); ++it) {
+        std::unique_ptr<BasicBlock>& owner = ir.blocks[(*it)->id];
+        ordered.push_back(std::move(owner));
+    }
+    ir.blocks = std::move(ordered);
+
+    int nextValue = 0;
+    for (size_t i = 0; i < ir.blocks.size(); ++i) {
+        BasicBlock* block = ir.blocks[i].get();
+        block->id = static_cast<int>(i);
+        for (IRInstruction* ins : block->instructions) {
+            if (ins->definesValue()) ins->id = nextValue++;
+        }
+    }
+}
+
+// ---- Lowering ----
+
+IRInstruction* IRBuilder::visitNode(ASTNodePtr node) {
+    throw std::runtime_error(std::string("Cannot compile ") + nodeKindToString(node->kind) + " node");
+}
+
+IRInstruction* IRBuilder::visitProgram(Program* p) {
+    lowerBlock(p->declarations);
+    lowerBlock(p->statements);
+    return nullptr;
+}
+
+IRInstruction* IRBuilder::visitDeclaration(Declaration* d) {
+    ValueType type = valueTypeFromName(std::string(d->dataType));
+
+    for (size_t i = 0; i < d->identifiers.size(); ++i) {
+        std::string_view name = d->identifiers[i];
+        ASTNodePtr init = i < d->initializers.size() ? d->initializers[i] : nullptr;
+
+        // Re-running a declaration (e.g. inside a loop body) resets the variable
+        IRInstruction* value = init ? convert(visit(init), type) : zero(type);
+        writeVariable(name, current, value);
+    }
+    return nullptr;
+}
+
+IRInstruction* IRBuilder::visitAssignment(Assignment* a) {
+    IRInstruction* value = convert(visit(a->expression), typeOf(a->identifier));
+    writeVariable(a->identifier, current, value);
+    return nullptr;
+}
+
+IRInstruction* IRBuilder::visitBinaryOp(BinaryOp* b) {
+    std::string_view op = b->operation;
+
+    // Short-circuit operators become control flow merging into a bool phi
+    if (op == "&&" || op == "||") {
+        bool isAnd = (op == "&&");
+        IRInstruction* left = toBool(visit(b->left));
+        IRInstruction* shortValue = constant(Value::ofBool(!isAnd));
+        BasicBlock* leftEnd = current;
+        BasicBlock* rightBlock = newBlock();
+        BasicBlock* join = newBlock();
+        if (isAnd) {
+            branch(left, rightBlock, join);
+        } else {
+            branch(left, join, rightBlock);
+        }
+        sealBlock(rightBlock);
+
+        current = rightBlock;
+        IRInstruction* right = toBool(visit(b->right));
+        jump(join);
+        sealBlock(join);
+
+        current = join;
+        IRInstruction* phi = ir.newInstruction(IROp::Phi, ValueType::Bool);
+        phi->block = join;
+        for (BasicBlock* pred : join->predecessors) {
+            phi->operands.push_back(pred == leftEnd ? shortValue : right);
+        }
+        join->instructions.insert(join->instructions.begin(), phi);
+        return phi;
+    }
+
+    IRInstruction* left = visit(b->left);
+    IRInstruction* right = visit(b->right);
+    ValueType type = checkedType(b), lt = left->type, rt = right->type;
+
+    // String concatenation: either side a string, the other is formatted
+    if (type == ValueType::String) {
+        if (lt != ValueType::String) left = emit(IROp::ToString, ValueType::String, {left});
+        if (rt != ValueType::String) right = emit(IROp::ToString, ValueType::String, {right});
+        return emit(IROp::Concat, type, {left, right});
+    }
+
+    if (type != ValueType::Bool) {
+        IROp arithmetic = op == "+" ? IROp::Add : op == "-" ? IROp::Sub : op == "*" ? IROp::Mul :
+                          op == "/" ? IROp::Div : op == "%" ? IROp::Mod : IROp::Pow;
+        if (type == ValueType::Int) return emit(arithmetic, type, {left, right});
+        return emit(arithmetic, type, {toFloat(left), toFloat(right)});
+    }
+
+    IROp comparison = op == "==" ? IROp::Equal : op == "!=" ? IROp::NotEqual : op == "<" ? IROp::Less :
+                      op == "<=" ? IROp::LessEqual : op == ">" ? IROp::Greater : IROp::GreaterEqual;
+    if (lt == rt) {
+        return emit(comparison, type, {left, right});
+    }
+    if (isNumeric(lt) && isNumeric(rt)) {
+        return emit(comparison, type, {toFloat(left), toFloat(right)});
+    }
+    return constant(Value::ofBool(op == "!="));  // Values of different types are never equal
+}
+
+IRInstruction* IRBuilder::visitUnaryOp(UnaryOp* u) {
+    IRInstruction* operand = visit(u->operand);
+
+    if (u->operation == "!") return emit(IROp::Not, ValueType::Bool, {toBool(operand)});
+    return emit(IROp::Neg, checkedType(u), {operand});
+}
+
+IRInstruction* IRBuilder::visitLiteral(Literal* l) {
+    if (l->dataType == "int") {
+        try {
+            return constant(Value::ofInt(std::stoll(std::string(l->value))));
+        } catch (const std::out_of_range&) {
+            throw std::runtime_error("Integer literal '" + std::string(l->value) + "' out of range");
+        }
+    }
+    if (l->dataType == "float") return constant(Value::ofFloat(std::stod(std::string(l->value))));
+    if (l->dataType == "bool") return constant(Value::ofBool(l->value == "true"));
+
+    ir.strings.emplace_back(l->value);
+    return constant(Value::ofString(&ir.strings.back()));
+}
+
+IRInstruction* IRBuilder::visitIdentifier(Identifier* id) {
+    typeOf(id->name);  // Must be declared
+    return readVariable(id->name, current);
+}
+
+IRInstruction* IRBuilder::visitFunctionCall(FunctionCall* f) {
+    if (f->functionName == "input") {
+        auto target = nodeAs<Identifier>(f->arguments.empty() ? nullptr : f->arguments[0]);
+        if (!target) throw std::runtime_error("listen expects a variable");
+
+        IRInstruction* value = emit(IROp::Read, typeOf(target->name));
+        value->variable = target->name;
+        writeVariable(target->name, current, value);
+        return nullptr;
+    }
+
+    emit(IROp::Print, ValueType::Int, {visit(f->arguments.at(0))});
+    return nullptr;
+}
+
+IRInstruction* IRBuilder::visitIfStatement(IfStatement* iff) {
+    IRInstruction* condition = visit(iff->condition);
+    BasicBlock* thenBlock = newBlock();
+    BasicBlock* join = newBlock();
+    BasicBlock* elseBlock = iff->elseBranch.empty() ? join : newBlock();
+
+    branch(condition, thenBlock, elseBlock);
+    sealBlock(thenBlock);
+    if (elseBlock != join) sealBlock(elseBlock);
+
+    current = thenBlock;
+    lowerBlock(iff->thenBranch);
+    if (current) jump(join);
+
+    if (elseBlock != join) {
+        current = elseBlock;
+        lowerBlock(iff->elseBranch);
+        if (current) jump(join);
+    }
+
+    sealBlock(join);
+    current = join->predecessors.empty() ? nullptr : join;  // Both branches returned
+    return nullptr;
+}
+
+IRInstruction* IRBuilder::visitWhileLoop(WhileLoop* w) {
+    BasicBlock* header = newBlock();
+    jump(header);
+
+    current = header;
+    IRInstruction* condition = visit(w->condition);
+    BasicBlock* body = newBlock();
+    BasicBlock* exit = newBlock();
+    branch(condition, body, exit);
+    sealBlock(body);
+
+    current = body;
+    lowerBlock(w->body);
+    if (current) jump(header);
+
+    sealBlock(header);  // The back edge is known now
+    sealBlock(exit);
+    current = exit;
+    return nullptr;
+}
+
+IRInstruction* IRBuilder::visitForLoop(ForLoop* f) {
+    if (f->initialization) visit(f->initialization);
+
+    BasicBlock* header = newBlock();
+    jump(header);
+
+    current = header;
+    IRInstruction* condition = visit(f->condition);
+    BasicBlock* body = newBlock();
+    BasicBlock* exit = newBlock();
+    branch(condition, body, exit);
+    sealBlock(body);
+
+    current = body;
+    lowerBlock(f->body);
+    if (current) {
+        if (f->increment) visit(f->increment);  // Evaluated and discarded
+        jump(header);
+    }
+
+    sealBlock(header);
+    sealBlock(exit);
+    current = exit;
+    return nullptr;
+}
+
+IRInstruction* IRBuilder::visitReturnStatement(ReturnStatement* r) {
+    // `return` ends the program; its value is evaluated and discarded
+    if (r->expression) visit(r->expression);
+    emit(IROp::Return, ValueType::Int);
+    current = nullptr;
+    return nullptr;
+}
@@ -0,0 +1,232 @@
+#include "../include/json_writer.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+JsonWriter::JsonWriter(std::ostream& o, bool p) : out(o), pretty(p) {
+    buffer.reserve(FLUSH_THRESHOLD + 4096);
+}
+
+void JsonWriter::flush() {
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+void JsonWriter::append(std::string_view s) {
+    buffer.append(s.data(), s.size());
+    if (buffer.size() >= FLUSH_THRESHOLD) flush();
+}
+
+void JsonWriter::append(char c) {
+    buffer.push_back(c);
+    if (buffer.size() >= FLUSH_THRESHOLD) flush();
+}
+
+void JsonWriter::newline() {
+    append('\n');
+    for (size_t i = 0; i < scopes.size(); ++i) append("  ");
+}
+
+// Separator and indentation before a value (or, in an object, its key)
+void JsonWriter::beginValue() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (scopes.empty()) return;
+
+    Scope& scope = scopes.back();
+    if (!scope.empty) append(',');
+    scope.empty = false;
+    if (pretty) newline();
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    beginValue();
+    writeString(name);
+    append(pretty ? ": " : ":");
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    beginValue();
+    append('{');
+    scopes.push_back({true});
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    beginValue();
+    append('[');
+    scopes.push_back({false});
+    return *this;
+}
+
+void JsonWriter::endScope(char close) {
+    bool empty = scopes.back().empty;
+    scopes.pop_back();
+    if (pretty && !empty) newline();
+    append(close);
+}
+
+JsonWriter& JsonWriter::endObject() {
+    endScope('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    endScope(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view s) {
+    beginValue();
+    writeString(s);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+    beginValue();
+    append(b ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int64_t n) {
+    beginValue();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), n);
+    append(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(uint64_t n) {
+    beginValue();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), n);
+    append(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double d) {
+    if (!std::isfinite(d)) return null();
+    beginValue();
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%.17g", d);
+    append(std::string_view(digits, static_cast<size_t>(length)));
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    beginValue();
+    append("null");
+    return *this;
+}
+
+JsonWriter& JsonWriter::members(std::string_view serialized) {
+    if (serialized.empty()) return *this;
+    beginValue();
+    append(serialized);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const Json::Value& v) {
+    switch (v.type()) {
+        case Json::nullValue: return null();
+        case Json::intValue: return value(static_cast<int64_t>(v.asInt64()));
+        case Json::uintValue: return value(static_cast<uint64_t>(v.asUInt64()));
+        case Json::realValue: return value(v.asDouble());
+        case Json::booleanValue: return value(v.asBool());
+        case Json::stringValue: {
+            const char* begin = nullptr;
+            const char* end = nullptr;
+            v.getString(&begin, &end);
+            return value(std::string_view(begin, static_cast<size_t>(end - begin)));
+        }
+        case Json::arrayValue:
+            beginArray();
+            for (const Json::Value& element : v) value(element);
+            return endArray();
+        case Json::objectValue:
+            beginObject();
+            for (auto it = v.begin(); it != v.end(); ++it) {
+                key(it.name());
+                value(*it);
+            }
+            return endObject();
+    }
+    return *this;
+}
+
+// Length of the well-formed UTF-8 sequence starting at s[i], or 0
+static size_t utf8SequenceLength(std::string_view s, size_t i) {
+    auto byte = [&s](size_t at) { return static_cast<unsigned char>(s[at]); };
+    unsigned char lead = byte(i);
+
+    size_t length;
+    unsigned char low = 0x80, high = 0xBF;  // Bounds on the second byte
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) low = 0xA0;       // Overlong
+        else if (lead == 0xED) high = 0x9F; // Surrogates
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) low = 0x90;       // Overlong
+        else if (lead == 0xF4) high = 0x8F; // Above U+10FFFF
+    } else {
+        return 0;
+    }
+
+    if (i + length > s.size()) return 0;
+    if (byte(i + 1) < low || byte(i + 1) > high) return 0;
+    for (size_t k = 2; k < length; ++k) {
+        if ((byte(i + k) & 0xC0) != 0x80) return 0;
+    }
+    return length;
+}
+
+void JsonWriter::writeString(std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+
+    append('"');
+    size_t run = 0;  // Start of the bytes that need no escaping
+    for (size_t i = 0; i < s.size();) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\') {
+            ++i;
+            continue;
+        }
+
+        size_t length = c >= 0x80 ? utf8SequenceLength(s, i) : 0;
+        if (length > 0) {
+            i += length;
+            continue;
+        }
+
+        append(s.substr(run, i - run));
+        switch (c) {
+            case '"': append("\\\""); break;
+            case '\\': append("\\\\"); break;
+            case '\b': append("\\b"); break;
+            case '\f': append("\\f"); break;
+            case '\n': append("\\n"); break;
+            case '\r': append("\\r"); break;
+            case '\t': append("\\t"); break;
+            default:
+                if (c >= 0x80) {
+                    append("\\ufffd");
+                } else {
+                    char escape[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                    append(std::string_view(escape, sizeof(escape)));
+                }
+                break;
+        }
+        run = ++i;
+    }
+    append(s.substr(run));
+    append('"');
+}
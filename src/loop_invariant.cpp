@@ -0,0 +1,197 @@
+#include "../include/loop_invariant.h"
+#include "../include/dead_code.h"
+
+static void collectDeclarations(ASTNodePtr node, std::unordered_map<std::string_view, ValueType>& variables) {
+    if (auto d = nodeAs<Declaration>(node)) {
+        ValueType type = valueTypeFromName(std::string(d->dataType));
+        for (std::string_view name : d->identifiers) variables[name] = type;
+    }
+    forEachChild(node, [&variables](ASTNodePtr child) { collectDeclarations(child, variables); });
+}
+
+// Variables a loop may change: assigned, (re-)declared or listened to
+static void collectWritten(ASTNodePtr node, std::unordered_set<std::string_view>& written) {
+    if (auto a = nodeAs<Assignment>(node)) {
+        written.insert(a->identifier);
+    } else if (auto d = nodeAs<Declaration>(node)) {
+        written.insert(d->identifiers.begin(), d->identifiers.end());
+    } else if (auto call = nodeAs<FunctionCall>(node); call && call->functionName == "input") {
+        for (ASTNodePtr argument : call->arguments) {
+            if (auto id = nodeAs<Identifier>(argument)) written.insert(id->name);
+        }
+    }
+    forEachChild(node, [&written](ASTNodePtr child) { collectWritten(child, written); });
+}
+
+// Structural key of an expression, equal for expressions that compute the same value
+static std::string expressionKey(ASTNodePtr node) {
+    if (auto l = nodeAs<Literal>(node)) return std::string(l->dataType) + ":" + std::string(l->value);
+    if (auto id = nodeAs<Identifier>(node)) return std::string(id->name);
+    if (auto u = nodeAs<UnaryOp>(node)) return std::string(u->operation) + "(" + expressionKey(u->operand) + ")";
+    if (auto b = nodeAs<BinaryOp>(node)) {
+        return "(" + expressionKey(b->left) + " " + std::string(b->operation) + " " + expressionKey(b->right) + ")";
+    }
+    return "?";
+}
+
+void LoopInvariantMotion::run(ASTNodePtr program) {
+    hoisted = 0;
+    nextTemporary = 0;
+
+    auto p = nodeAs<Program>(program);
+    if (!p) return;
+
+    variables.clear();
+    collectDeclarations(p, variables);
+    processBlock(p->statements);
+}
+
+// Handle every loop in `statements`, innermost first, inserting each loop's
+// temporaries right before it
+void LoopInvariantMotion::processBlock(ASTNodeList& statements) {
+    ASTNodeList result(statements.get_allocator());
+
+    for (ASTNodePtr stmt : statements) {
+        if (auto iff = nodeAs<IfStatement>(stmt)) {
+            processBlock(iff->thenBranch);
+            processBlock(iff->elseBranch);
+        } else if (stmt && (stmt->kind == NodeKind::WhileLoop || stmt->kind == NodeKind::ForLoop)) {
+            // Inner loops first; their temporaries count as written here
+            Loop loop;
+            if (auto w = nodeAs<WhileLoop>(stmt)) {
+                processBlock(w->body);
+                collectWritten(stmt, loop.written);
+                w->condition = hoist(w->condition, loop);
+                hoistFromBlock(w->body, loop);
+            } else {
+                auto f = static_cast<ForLoop*>(stmt);
+                processBlock(f->body);
+                collectWritten(stmt, loop.written);
+                f->condition = hoist(f->condition, loop);
+                hoistFromBlock(f->body, loop);
+                f->increment = hoist(f->increment, loop);
+            }
+            result.insert(result.end(), loop.temporaries.begin(), loop.temporaries.end());
+        }
+        result.push_back(stmt);
+    }
+    statements.swap(result);
+}
+
+void LoopInvariantMotion::hoistFromBlock(ASTNodeList& statements, Loop& loop) {
+    for (ASTNodePtr stmt : statements) hoistFromStatement(stmt, loop);
+}
+
+void LoopInvariantMotion::hoistFromStatement(ASTNodePtr stmt, Loop& loop) {
+    if (!stmt) return;
+
+    switch (stmt->kind) {
+        case NodeKind::Declaration:
+            for (ASTNodePtr& init : static_cast<Declaration*>(stmt)->initializers) init = hoist(init, loop);
+            break;
+        case NodeKind::Assignment: {
+            auto a = static_cast<Assignment*>(stmt);
+            a->expression = hoist(a->expression, loop);
+            break;
+        }
+        case NodeKind::FunctionCall: {
+            auto call = static_cast<FunctionCall*>(stmt);
+            if (call->functionName == "input") break;  // Its argument is the variable written
+            for (ASTNodePtr& argument : call->arguments) argument = hoist(argument, loop);
+            break;
+        }
+        case NodeKind::IfStatement: {
+            auto iff = static_cast<IfStatement*>(stmt);
+            iff->condition = hoist(iff->condition, loop);
+            hoistFromBlock(iff->thenBranch, loop);
+            hoistFromBlock(iff->elseBranch, loop);
+            break;
+        }
+        case NodeKind::WhileLoop: {
+            auto w = static_cast<WhileLoop*>(stmt);
+            w->condition = hoist(w->condition, loop);
+            hoistFromBlock(w->body, loop);
+            break;
+        }
+        case NodeKind::ForLoop: {
+            auto f = static_cast<ForLoop*>(stmt);
+            hoistFromStatement(f->initialization, loop);
+            f->condition = hoist(f->condition, loop);
+            hoistFromBlock(f->body, loop);
+            f->increment = hoist(f->increment, loop);
+            break;
+        }
+        default:
+            break;  // return runs at most once
+    }
+}
+
+// Replace the largest invariant operator expressions within `expression`
+// by temporaries; returns the (possibly replaced) expression
+ASTNodePtr LoopInvariantMotion::hoist(ASTNodePtr expression, Loop& loop) {
+    if (!expression) return expression;
+
+    auto b = nodeAs<BinaryOp>(expression);
+    auto u = nodeAs<UnaryOp>(expression);
+    if (!b && !u) return expression;
+
+    // A lone -x or !x costs no more than reading a temporary
+    bool worthwhile = b || u->operand->kind == NodeKind::BinaryOp || u->operand->kind == NodeKind::UnaryOp;
+    if (worthwhile && isInvariant(expression, loop.written)) {
+        if (auto type = safeType(expression, variables)) {
+            std::string key = expressionKey(expression);
+            auto it = loop.byExpression.find(key);
+            std::string_view name;
+            if (it != loop.byExpression.end()) {
+                name = it->second;
+            } else {
+                name = newTemporary();
+                variables[name] = *type;
+                loop.byExpression.emplace(std::move(key), name);
+
+                auto d = arena.make<Declaration>();
+                d->dataType = valueTypeToString(*type);
+                d->identifiers.push_back(name);
+                d->initializers.push_back(expression);
+                loop.temporaries.push_back(d);
+                ++hoisted;
+            }
+
+            auto id = arena.make<Identifier>();
+            id->name = name;
+            return id;
+        }
+    }
+
+    if (b) {
+        b->left = hoist(b->left, loop);
+        b->right = hoist(b->right, loop);
+    } else {
+        u->operand = hoist(u->operand, loop);
+    }
+    return expression;
+}
+
+bool LoopInvariantMotion::isInvariant(ASTNodePtr expression, const Names& written) const {
+    if (auto id = nodeAs<Identifier>(expression)) return !written.count(id->name);
+    if (expression->kind != NodeKind::Literal && expression->kind != NodeKind::BinaryOp &&
+        expression->kind != NodeKind::UnaryOp) {
+        return false;
+    }
+
+    bool invariant = true;
+    forEachChild(expression, [&](ASTNodePtr child) {
+        if (invariant && child) invariant = isInvariant(child, written);
+    });
+    return invariant;
+}
+
+// A shard name the program does not use; `_` keeps it out of the way of
+// ordinary identifiers
+std::string_view LoopInvariantMotion::newTemporary() {
+    std::string name;
+    do {
+        name = "_inv" + std::to_string(nextTemporary++);
+    } while (variables.count(name));
+    return arena.copyString(name);
+}
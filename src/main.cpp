@@ -1,275 +1,266 @@
 #include "../include/parser.h"
-#include <iostream>
+#include "../include/driver.h"
+#include "../include/server.h"
+#include "../include/batch.h"
+#include "../include/bytecode_compiler.h"
+#include "../include/vm.h"
+#include "../include/asm_generator.h"
+#include "../include/c_generator.h"
+#include "../include/optimizer.h"
+#include "../include/ir_builder.h"
+#include "../include/binary_format.h"
+#include <climits>
+#include <cstdint>
 #include <fstream>
+#include <iostream>
 #include <sstream>
-#include <json/json.h>
-
-// Helper function to convert AST to JSON (recursive tree representation)
-Json::Value makeAstNode(const ASTNodePtr& n) {
-    Json::Value obj(Json::objectValue);
-    if (!n) {
-        obj["label"] = "<null>";
-        return obj;
-    }
-
-    std::string t = n->getType();
-    if (t == "Program") {
-        auto p = std::static_pointer_cast<Program>(n);
-        obj["label"] = "PROGRAM";
-        Json::Value children(Json::arrayValue);
-        for (auto& decl : p->declarations) children.append(makeAstNode(decl));
-        for (auto& stmt : p->statements) children.append(makeAstNode(stmt));
-        obj["children"] = children;
-        return obj;
-    }
+#include <stdexcept>
 
-    if (t == "Declaration") {
-        auto d = std::static_pointer_cast<Declaration>(n);
-        Json::Value children(Json::arrayValue);
-        for (size_t i = 0; i < d->identifiers.size(); ++i) {
-            std::string name = d->identifiers[i];
-            std::string label = "VAR_DECL(" + d->dataType + " " + name + ")";
-            Json::Value idNode(Json::objectValue);
-            idNode["label"] = label;
-            if (i < d->initializers.size() && d->initializers[i] != nullptr) {
-                Json::Value sub(Json::arrayValue);
-                sub.append(makeAstNode(d->initializers[i]));
-                idNode["children"] = sub;
-            }
-            children.append(idNode);
-        }
-        obj["label"] = "DECL";
-        obj["children"] = children;
-        return obj;
-    }
-
-    if (t == "Assignment") {
-        auto a = std::static_pointer_cast<Assignment>(n);
-        obj["label"] = std::string("ASSIGN(") + a->identifier + ")";
-        Json::Value children(Json::arrayValue);
-        if (a->expression) children.append(makeAstNode(a->expression));
-        obj["children"] = children;
-        return obj;
-    }
-
-    if (t == "BinaryOp") {
-        auto b = std::static_pointer_cast<BinaryOp>(n);
-        obj["label"] = std::string("EXPR(") + b->operation + ")";
-        Json::Value children(Json::arrayValue);
-        if (b->left) children.append(makeAstNode(b->left));
-        if (b->right) children.append(makeAstNode(b->right));
-        obj["children"] = children;
-        return obj;
-    }
-
-    if (t == "UnaryOp") {
-        auto u = std::static_pointer_cast<UnaryOp>(n);
-        obj["label"] = std::string("UNARY(") + u->operation + ")";
-        Json::Value children(Json::arrayValue);
-        if (u->operand) children.append(makeAstNode(u->operand));
-        obj["children"] = children;
-        return obj;
+// Run a source-to-source backend (AsmGenerator, CGenerator) and write its
+// output to `path`; returns the process exit code
+template <typename Generator>
+static int writeGenerated(ASTNodePtr ast, const std::string& path) {
+    std::ostringstream generated;
+    try {
+        Generator().generate(ast, generated);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
     }
-
-    if (t == "Literal") {
-        auto l = std::static_pointer_cast<Literal>(n);
-        obj["label"] = l->value;
-        return obj;
+    
+    std::ofstream out(path, std::ios::binary);
+    if (!out || !(out << generated.str())) {
+        std::cerr << "Error: Cannot write " << path << std::endl;
+        return 1;
     }
+    return 0;
+}
 
-    if (t == "Identifier") {
-        auto id = std::static_pointer_cast<Identifier>(n);
-        obj["label"] = id->name;
-        return obj;
+// Parse the non-negative integer value of `option`; prints an error and
+// returns false if `text` is not one or exceeds `max`
+static bool parseCount(const std::string& text, const std::string& option, unsigned long max,
+                       unsigned long& value) {
+    try {
+        size_t used = 0;
+        value = std::stoul(text, &used);
+        if (used == text.size() && text[0] != '-' && value <= max) return true;
+    } catch (const std::logic_error&) {
     }
+    std::cerr << "Error: Invalid value for " << option << ": " << text << std::endl;
+    return false;
+}
 
-    if (t == "FunctionCall") {
-        auto f = std::static_pointer_cast<FunctionCall>(n);
-        obj["label"] = std::string("CALL(") + f->functionName + ")";
-        Json::Value children(Json::arrayValue);
-        for (auto& a : f->arguments) children.append(makeAstNode(a));
-        obj["children"] = children;
-        return obj;
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <source_file> [-O] [--json [--pretty] [--emit=<sections>] | --run [--stats] | --emit-bytecode | --emit-ir | --emit-asm <out.s> | --emit-c <out.c> | --emit-binary <out.bin>]" << std::endl;
+        std::cerr << "       " << argv[0] << " --serve [--cache-size MiB]" << std::endl;
+        std::cerr << "       " << argv[0] << " --batch <directory> [-j N] [--pretty] [--cache-size MiB] [--cache-dir <dir>]" << std::endl;
+        return 1;
     }
-
-    if (t == "IfStatement") {
-        auto iff = std::static_pointer_cast<IfStatement>(n);
-        obj["label"] = "IF";
-        Json::Value children(Json::arrayValue);
-        if (iff->condition) children.append(makeAstNode(iff->condition));
-        Json::Value thenNode(Json::objectValue);
-        thenNode["label"] = "THEN";
-        Json::Value thenChildren(Json::arrayValue);
-        for (auto& s : iff->thenBranch) thenChildren.append(makeAstNode(s));
-        thenNode["children"] = thenChildren;
-        children.append(thenNode);
-        if (!iff->elseBranch.empty()) {
-            Json::Value elseNode(Json::objectValue);
-            elseNode["label"] = "ELSE";
-            Json::Value elseChildren(Json::arrayValue);
-            for (auto& s : iff->elseBranch) elseChildren.append(makeAstNode(s));
-            elseNode["children"] = elseChildren;
-            children.append(elseNode);
+    
+    if (std::string(argv[1]) == "--serve") {
+        size_t cacheBytes = DEFAULT_CACHE_BYTES;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--cache-size" && i + 1 < argc) {
+                unsigned long mib;
+                if (!parseCount(argv[++i], "--cache-size", SIZE_MAX >> 20, mib)) return 1;
+                cacheBytes = static_cast<size_t>(mib) << 20;
+            } else {
+                std::cerr << "Error: Unknown option " << arg << std::endl;
+                return 1;
+            }
         }
-        obj["children"] = children;
-        return obj;
-    }
-
-    if (t == "WhileLoop") {
-        auto w = std::static_pointer_cast<WhileLoop>(n);
-        obj["label"] = "WHILE";
-        Json::Value children(Json::arrayValue);
-        if (w->condition) children.append(makeAstNode(w->condition));
-        Json::Value body(Json::objectValue);
-        body["label"] = "BODY";
-        Json::Value bodyChildren(Json::arrayValue);
-        for (auto& s : w->body) bodyChildren.append(makeAstNode(s));
-        body["children"] = bodyChildren;
-        children.append(body);
-        obj["children"] = children;
-        return obj;
-    }
-
-    if (t == "ForLoop") {
-        auto f = std::static_pointer_cast<ForLoop>(n);
-        obj["label"] = "FOR";
-        Json::Value children(Json::arrayValue);
-        if (f->initialization) children.append(makeAstNode(f->initialization));
-        if (f->condition) children.append(makeAstNode(f->condition));
-        if (f->increment) children.append(makeAstNode(f->increment));
-        Json::Value body(Json::objectValue);
-        body["label"] = "BODY";
-        Json::Value bodyChildren(Json::arrayValue);
-        for (auto& s : f->body) bodyChildren.append(makeAstNode(s));
-        body["children"] = bodyChildren;
-        children.append(body);
-        obj["children"] = children;
-        return obj;
-    }
-
-    if (t == "ReturnStatement") {
-        auto r = std::static_pointer_cast<ReturnStatement>(n);
-        obj["label"] = "RETURN";
-        Json::Value children(Json::arrayValue);
-        if (r->expression) children.append(makeAstNode(r->expression));
-        obj["children"] = children;
-        return obj;
+        std::ios::sync_with_stdio(false);
+        return runServer(std::cin, std::cout, cacheBytes);
     }
-
-    if (t == "Function") {
-        auto fn = std::static_pointer_cast<Function>(n);
-        obj["label"] = std::string("FUNC(") + fn->name + ")";
-        Json::Value children(Json::arrayValue);
-        for (auto& p : fn->parameters) children.append(makeAstNode(p));
-        for (auto& s : fn->body) children.append(makeAstNode(s));
-        obj["children"] = children;
-        return obj;
+    
+    if (std::string(argv[1]) == "--batch") {
+        if (argc < 3) {
+            std::cerr << "Error: --batch requires a directory" << std::endl;
+            return 1;
+        }
+        unsigned jobs = 0;  // 0 = one worker per hardware thread
+        bool prettyJson = false;
+        size_t cacheBytes = DEFAULT_CACHE_BYTES;
+        std::string cacheDir;
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--pretty") {
+                prettyJson = true;
+            } else if (arg == "--cache-size" && i + 1 < argc) {
+                unsigned long mib;
+                if (!parseCount(argv[++i], "--cache-size", SIZE_MAX >> 20, mib)) return 1;
+                cacheBytes = static_cast<size_t>(mib) << 20;
+            } else if (arg == "--cache-dir" && i + 1 < argc) {
+                cacheDir = argv[++i];
+            } else if (arg.rfind("-j", 0) == 0 && (arg.size() > 2 || i + 1 < argc)) {
+                unsigned long value;
+                if (!parseCount(arg.size() > 2 ? arg.substr(2) : argv[++i], "-j", UINT_MAX, value)) return 1;
+                jobs = static_cast<unsigned>(value);
+            } else {
+                std::cerr << "Error: Unknown option " << arg << std::endl;
+                return 1;
+            }
+        }
+        std::ios::sync_with_stdio(false);
+        return runBatch(argv[2], jobs, std::cout, prettyJson, cacheBytes, cacheDir);
     }
-
-    // Fallback: include toString as label
-    obj["label"] = n->toString();
-    return obj;
-}
-
-Json::Value astToJson(const ASTNodePtr& node) {
-    return makeAstNode(node);
-}
-
-// Helper function to convert errors to JSON
-Json::Value errorsToJson(const std::vector<std::shared_ptr<Error>>& errors) {
-    Json::Value result(Json::arrayValue);
     
-    for (const auto& err : errors) {
-        Json::Value errObj(Json::objectValue);
-        errObj["message"] = err->message;
-        errObj["line"] = err->line;
-        errObj["column"] = err->column;
-        errObj["type"] = err->typeToString();
-        result.append(errObj);
+    std::string filename = argv[1];
+    bool outputJson = false;
+    bool prettyJson = false;
+    unsigned emitSections = EMIT_ALL;
+    bool runProgram = false;
+    bool emitBytecode = false;
+    bool emitIR = false;
+    bool showStats = false;
+    bool optimizeAst = false;
+    std::string asmFile;
+    std::string cFile;
+    std::string binaryFile;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json") {
+            outputJson = true;
+        } else if (arg == "--pretty") {
+            prettyJson = true;
+        } else if (arg.rfind("--emit=", 0) == 0) {
+            // Implies --json: errors,symbols,tokens,ast
+            try {
+                emitSections = parseEmitSections(arg.substr(7));
+            } catch (const std::runtime_error& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+            outputJson = true;
+        } else if (arg == "--run") {
+            runProgram = true;
+        } else if (arg == "--stats") {
+            showStats = true;
+        } else if (arg == "-O" || arg == "--optimize") {
+            optimizeAst = true;
+        } else if (arg == "--emit-bytecode") {
+            emitBytecode = true;
+        } else if (arg == "--emit-ir") {
+            emitIR = true;
+        } else if (arg == "--emit-asm" && i + 1 < argc) {
+            asmFile = argv[++i];
+        } else if (arg == "--emit-c" && i + 1 < argc) {
+            cFile = argv[++i];
+        } else if (arg == "--emit-binary" && i + 1 < argc) {
+            binaryFile = argv[++i];
+        } else {
+            std::cerr << "Error: Unknown option " << arg << std::endl;
+            return 1;
+        }
     }
     
-    return result;
-}
-
-// Helper to convert tokens to JSON
-Json::Value tokensToJson(const std::vector<Token>& tokens) {
-    Json::Value arr(Json::arrayValue);
-    for (const auto& t : tokens) {
-        Json::Value obj(Json::objectValue);
-        obj["type"] = t.typeToString();
-        obj["value"] = t.value;
-        obj["line"] = t.line;
-        obj["column"] = t.column;
-        arr.append(obj);
+    // Map the source file; the scanner reads it in place
+    std::string ioError;
+    auto source = SourceBuffer::fromFile(filename, ioError);
+    if (!source) {
+        std::cerr << "Error: " << ioError << std::endl;
+        return 1;
     }
-    return arr;
-}
-
-// Helper function to convert symbol table to JSON
-Json::Value symbolTableToJson(const SymbolTable& table) {
-    Json::Value result(Json::objectValue);
     
-    for (const auto& pair : table.getAllSymbols()) {
-        Json::Value symbolObj(Json::objectValue);
-        symbolObj["name"] = pair.second->name;
-        symbolObj["type"] = pair.second->type;
-        symbolObj["line"] = pair.second->line;
-        symbolObj["column"] = pair.second->column;
-        result[pair.first] = symbolObj;
+    if (outputJson) {
+        // Streamed as the tree is walked; compact unless --pretty
+        std::ios::sync_with_stdio(false);
+        JsonWriter json(std::cout, prettyJson);
+        json.beginObject();
+        bool hasErrors = writeCompileResult(json, source, optimizeAst, emitSections);
+        json.endObject();
+        json.flush();
+        std::cout << std::endl;
+        return hasErrors ? 1 : 0;
     }
     
-    return result;
-}
-
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <source_file> [--json]" << std::endl;
-        return 1;
+    // Parse (the token stream is only needed for JSON and binary output)
+    Parser parser(source, !binaryFile.empty());
+    ASTNodePtr ast = parser.parse();
+    
+    if (optimizeAst && !parser.hasErrors()) {
+        OptimizerStats stats = optimize(ast, parser.getArena());
+        if (showStats) {
+            stats.writeReport(std::cerr);
+        }
     }
     
-    std::string filename = argv[1];
-    bool outputJson = (argc > 2 && std::string(argv[2]) == "--json");
+    // Written even with errors: the file carries the diagnostics
+    if (!binaryFile.empty()) {
+        std::ofstream out(binaryFile, std::ios::binary);
+        try {
+            writeBinary(out, parser.getTokens(), ast, parser.getErrors());
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        if (!out.flush()) {
+            std::cerr << "Error: Cannot write " << binaryFile << std::endl;
+            return 1;
+        }
+        return parser.hasErrors() ? 1 : 0;
+    }
     
-    // Read source file
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
-        return 1;
+    if (emitIR && !parser.hasErrors()) {
+        try {
+            dumpIR(IRBuilder().build(ast), std::cout);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
     }
     
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string source = buffer.str();
-    file.close();
+    if (!asmFile.empty() && !parser.hasErrors()) {
+        return writeGenerated<AsmGenerator>(ast, asmFile);
+    }
     
-    // Parse
-    Parser parser(source);
-    ASTNodePtr ast = parser.parse();
+    if (!cFile.empty() && !parser.hasErrors()) {
+        return writeGenerated<CGenerator>(ast, cFile);
+    }
     
-    if (outputJson) {
-        Json::Value output(Json::objectValue);
-        output["errors"] = errorsToJson(parser.getErrors());
-        output["symbolTable"] = symbolTableToJson(parser.getSymbolTable());
-        output["hasErrors"] = parser.hasErrors();
-        output["errorCount"] = static_cast<int>(parser.getErrors().size());
-        output["tokens"] = tokensToJson(parser.getTokens());
-        output["ast"] = astToJson(ast);
+    if ((runProgram || emitBytecode) && !parser.hasErrors()) {
+        Chunk chunk;
+        try {
+            chunk = BytecodeCompiler().compile(ast);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        
+        if (emitBytecode) {
+            disassemble(chunk, std::cout);
+            return 0;
+        }
+        
+        std::ios::sync_with_stdio(false);
+        VM vm(chunk, std::cin, std::cout);
+        vm.setProfiling(showStats);
+        bool ok = vm.run();
+        std::cout.flush();
         
-        Json::StreamWriterBuilder writer;
-        writer["indentation"] = "  ";
-        std::cout << Json::writeString(writer, output);
+        if (showStats) {
+            vm.getStats().writeReport(std::cerr);
+        }
+        if (!ok) {
+            std::cerr << "Runtime error: " << vm.getError()->message << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (!parser.hasErrors()) {
+        std::cout << "Parsing successful!" << std::endl;
+        std::cout << "Symbol Table:" << std::endl;
+        for (const auto& pair : parser.getSymbolTable().getAllSymbols()) {
+            std::cout << "  " << pair.first << " : " << pair.second->type << std::endl;
+        }
     } else {
-        if (!parser.hasErrors()) {
-            std::cout << "Parsing successful!" << std::endl;
-            std::cout << "Symbol Table:" << std::endl;
-            for (const auto& pair : parser.getSymbolTable().getAllSymbols()) {
-                std::cout << "  " << pair.first << " : " << pair.second->type << std::endl;
-            }
-        } else {
-            std::cout << "Parsing completed with " << parser.getErrors().size() << " error(s):" << std::endl;
-            for (const auto& err : parser.getErrors()) {
-                std::cout << "  " << err->toString() << std::endl;
-            }
+        std::cout << "Parsing completed with " << parser.getErrors().size() << " error(s):" << std::endl;
+        for (const auto& err : parser.getErrors()) {
+            std::cout << "  " << err->toString() << std::endl;
         }
     }
     
@@ -0,0 +1,56 @@
+#include "../include/optimizer.h"
+#include "../include/constant_folder.h"
+#include "../include/dead_code.h"
+#include "../include/loop_invariant.h"
+#include "../include/type_checker.h"
+#include <cstdio>
+
+size_t countNodes(ASTNodePtr node) {
+    if (!node) return 0;
+    size_t count = 1;
+    forEachChild(node, [&count](ASTNodePtr child) { count += countNodes(child); });
+    return count;
+}
+
+OptimizerStats optimize(ASTNodePtr program, AstArena& arena, SymbolTable* symbols) {
+    OptimizerStats stats;
+    stats.nodesBefore = countNodes(program);
+
+    ConstantFolder folder(arena);
+    folder.run(program);
+    stats.folded = folder.getFolded();
+    stats.simplified = folder.getSimplified();
+
+    DeadCodeEliminator dce;
+    dce.run(program);
+    stats.branches = dce.getBranches();
+    stats.unreachable = dce.getUnreachable();
+    stats.variables = dce.getVariables();
+    if (symbols) {
+        for (std::string_view name : dce.getRemovedNames()) symbols->removeSymbol(std::string(name));
+    }
+
+    LoopInvariantMotion licm(arena);
+    licm.run(program);
+    stats.hoisted = licm.getHoisted();
+
+    // Annotate the nodes the passes created; the rewrites preserve types
+    TypeChecker().check(program);
+
+    stats.nodesAfter = countNodes(program);
+    return stats;
+}
+
+void OptimizerStats::writeReport(std::ostream& report) const {
+    report << "AST nodes eliminated: " << eliminated() << " of " << nodesBefore;
+    if (nodesBefore > 0) {
+        char percent[32];
+        std::snprintf(percent, sizeof(percent), " (%.1f%%)", 100.0 * eliminated() / nodesBefore);
+        report << percent;
+    }
+    report << "\n";
+    report << "  constant folding: " << folded << " folded, " << simplified << " simplified\n";
+    report << "  dead code: " << branches << " constant branches, " << unreachable << " unreachable statements, "
+           << variables << " unused variables\n";
+    report << "  loop-invariant code motion: " << hoisted << " expressions hoisted\n";
+}
@@ -1,29 +1,54 @@
 #include "../include/parser.h"
+#include "../include/type_checker.h"
 #include <algorithm>
+#include <cassert>
 #include <iostream>
 
-Parser::Parser(const std::string& source)
-    : scanner(source), current(0) {}
+Parser::Parser(const std::string& source, bool recordTokens)
+    : scanner(source), current(0), fetched(0), reachedEnd(false), recordTokens(recordTokens) {}
 
-Token Parser::peek() const {
-    if (current < tokens.size()) {
-        return tokens[current];
+Parser::Parser(std::shared_ptr<const SourceBuffer> source, bool recordTokens)
+    : scanner(std::move(source)), current(0), fetched(0), reachedEnd(false), recordTokens(recordTokens) {}
+
+void Parser::fetchToken() {
+    Token token;
+    if (reachedEnd) {
+        // Reads past the end see a positionless EOF token
+        token = Token(TokenType::END_OF_FILE, "", 0, 0);
+    } else {
+        do {
+            token = scanner.nextToken();
+        } while (token.type == TokenType::NEWLINE);  // Newlines are not significant to the grammar
+        
+        reachedEnd = (token.type == TokenType::END_OF_FILE);
+        if (recordTokens) {
+            tokens.push_back(token);
+        }
     }
-    return Token(TokenType::END_OF_FILE, "", 0, 0);
+    ring[fetched % TOKEN_RING_SIZE] = token;
+    fetched++;
 }
 
-Token Parser::peekAhead(int distance) const {
-    if (current + distance < tokens.size()) {
-        return tokens[current + distance];
-    }
-    return Token(TokenType::END_OF_FILE, "", 0, 0);
+const Token& Parser::peek() {
+    return peekAhead(0);
 }
 
-Token Parser::advance() {
-    if (current < tokens.size()) {
-        return tokens[current++];
+const Token& Parser::peekAhead(int distance) {
+    assert(distance >= 0 && static_cast<size_t>(distance) <= MAX_LOOKAHEAD);
+    while (fetched <= current + distance) {
+        fetchToken();
     }
-    return Token(TokenType::END_OF_FILE, "", 0, 0);
+    return ring[(current + distance) % TOKEN_RING_SIZE];
+}
+
+const Token& Parser::previous() const {
+    return ring[(current - 1) % TOKEN_RING_SIZE];
+}
+
+const Token& Parser::advance() {
+    const Token& token = peek();
+    current++;
+    return token;
 }
 
 bool Parser::match(TokenType type) {
@@ -34,7 +59,7 @@ bool Parser::match(TokenType type) {
     return false;
 }
 
-bool Parser::match(const std::vector<TokenType>& types) {
+bool Parser::match(std::initializer_list<TokenType> types) {
     for (TokenType type : types) {
         if (check(type)) {
             advance();
@@ -44,11 +69,11 @@ bool Parser::match(const std::vector<TokenType>& types) {
     return false;
 }
 
-bool Parser::check(TokenType type) const {
+bool Parser::check(TokenType type) {
     return peek().type == type;
 }
 
-void Parser::consume(TokenType type, const std::string& message) {
+void Parser::consume(TokenType type, const char* message) {
     if (!check(type)) {
         error(message, peek().line, peek().column, ErrorType::PARSER);
     }
@@ -59,23 +84,23 @@ void Parser::error(const std::string& message, int line, int column, ErrorType t
     errors.push_back(std::make_shared<Error>(message, line, column, type));
 }
 
-void Parser::declareIdentifier(const std::string& name, const std::string& type, int line, int column) {
+void Parser::declareIdentifier(std::string_view name, const std::string& type, int line, int column) {
     try {
-        symbolTable.addSymbol(name, type, line, column);
+        symbolTable.addSymbol(std::string(name), type, line, column);
     } catch (const std::runtime_error& e) {
         error(e.what(), line, column, ErrorType::SEMANTIC);
     }
 }
 
-void Parser::validateIdentifier(const std::string& name, int line, int column) {
-    if (!symbolTable.exists(name)) {
-        error("Symbol '" + name + "' not declared", line, column, ErrorType::SEMANTIC);
+void Parser::validateIdentifier(std::string_view name, int line, int column) {
+    if (!symbolTable.exists(std::string(name))) {
+        error("Symbol '" + std::string(name) + "' not declared", line, column, ErrorType::SEMANTIC);
     }
 }
 
 // Parse methods (recursive descent)
 ASTNodePtr Parser::parseProgram() {
-    auto program = std::make_shared<Program>();
+    auto program = arena.make<Program>();
     
     if (!match(TokenType::MAIN) && !match(TokenType::NEXUS)) {
         error("Expected 'main' or 'nexus' keyword", peek().line, peek().column, ErrorType::PARSER);
@@ -104,7 +129,7 @@ ASTNodePtr Parser::parseProgram() {
 }
 
 ASTNodeList Parser::parseDeclarations() {
-    ASTNodeList declarations;
+    ASTNodeList declarations(arena.getResource());
     
     while (check(TokenType::VAR) || check(TokenType::SHARD)) {
         auto decl = parseDeclaration();
@@ -122,7 +147,7 @@ ASTNodePtr Parser::parseDeclaration() {
         return nullptr;
     }
     
-    auto declaration = std::make_shared<Declaration>();
+    auto declaration = makeNode<Declaration>(previous());
     
     // Parse type (accept both old and new keywords)
     if (match(TokenType::INT) || match(TokenType::CORE)) {
@@ -145,9 +170,9 @@ ASTNodePtr Parser::parseDeclaration() {
             return nullptr;
         }
         
-        Token idToken = advance();
+        const Token& idToken = advance();
         declaration->identifiers.push_back(idToken.value);
-        declareIdentifier(idToken.value, declaration->dataType, idToken.line, idToken.column);
+        declareIdentifier(idToken.value, std::string(declaration->dataType), idToken.line, idToken.column);
         
         // Check for initialization
         if (match(TokenType::ASSIGN)) {
@@ -171,7 +196,7 @@ ASTNodePtr Parser::parseDeclaration() {
 }
 
 ASTNodeList Parser::parseStatements() {
-    ASTNodeList statements;
+    ASTNodeList statements(arena.getResource());
     
     while (!check(TokenType::RBRACE) && !check(TokenType::END_OF_FILE)) {
         if (check(TokenType::NEWLINE)) {
@@ -204,27 +229,29 @@ ASTNodePtr Parser::parseStatement() {
         return parseReturnStatement();
     } else if (match(TokenType::INPUT) || match(TokenType::LISTEN)) {
         if (check(TokenType::IDENTIFIER)) {
-            Token id = advance();
+            const Token& id = advance();
             validateIdentifier(id.value, id.line, id.column);
+            auto identifier = makeNode<Identifier>(id);
+            identifier->name = id.value;
             // Require semicolon after input statement
             consume(TokenType::SEMICOLON, "Expected ';' after input");
-            auto identifier = std::make_shared<Identifier>();
-            identifier->name = id.value;
-            auto funcCall = std::make_shared<FunctionCall>();
+            auto funcCall = arena.make<FunctionCall>();
+            funcCall->line = identifier->line;
+            funcCall->column = identifier->column;
             funcCall->functionName = "input";
-            funcCall->arguments = std::vector<ASTNodePtr>{identifier};
+            funcCall->arguments.push_back(identifier);
             return funcCall;
         } else {
             error("Expected identifier after 'input'", peek().line, peek().column, ErrorType::PARSER);
             return nullptr;
         }
     } else if (match(TokenType::OUTPUT) || match(TokenType::BROADCAST)) {
+        auto funcCall = makeNode<FunctionCall>(previous());
         auto expr = parseExpression();
         // Require semicolon after output/broadcast
         consume(TokenType::SEMICOLON, "Expected ';' after output");
-        auto funcCall = std::make_shared<FunctionCall>();
         funcCall->functionName = "output";
-        funcCall->arguments = std::vector<ASTNodePtr>{expr};
+        funcCall->arguments.push_back(expr);
         return funcCall;
     }
     
@@ -248,14 +275,14 @@ ASTNodePtr Parser::parseAssignment() {
         error("Expected ';' after assignment", peek().line, peek().column, ErrorType::PARSER);
     }
     
-    auto assignment = std::make_shared<Assignment>();
+    auto assignment = makeNode<Assignment>(id);
     assignment->identifier = id.value;
     assignment->expression = expr;
     return assignment;
 }
 
 ASTNodePtr Parser::parseIfStatement() {
-    auto ifStmt = std::make_shared<IfStatement>();
+    auto ifStmt = makeNode<IfStatement>(previous());
     
     if (!match(TokenType::LPAREN)) {
         error("Expected '(' after 'if'", peek().line, peek().column, ErrorType::PARSER);
@@ -295,7 +322,7 @@ ASTNodePtr Parser::parseIfStatement() {
 }
 
 ASTNodePtr Parser::parseWhileLoop() {
-    auto whileLoop = std::make_shared<WhileLoop>();
+    auto whileLoop = makeNode<WhileLoop>(previous());
     
     if (!match(TokenType::LPAREN)) {
         error("Expected '(' after 'while'", peek().line, peek().column, ErrorType::PARSER);
@@ -324,7 +351,7 @@ ASTNodePtr Parser::parseWhileLoop() {
 }
 
 ASTNodePtr Parser::parseForLoop() {
-    auto forLoop = std::make_shared<ForLoop>();
+    auto forLoop = makeNode<ForLoop>(previous());
     
     if (!match(TokenType::LPAREN)) {
         error("Expected '(' after 'for'", peek().line, peek().column, ErrorType::PARSER);
@@ -360,7 +387,7 @@ ASTNodePtr Parser::parseForLoop() {
 }
 
 ASTNodePtr Parser::parseReturnStatement() {
-    auto retStmt = std::make_shared<ReturnStatement>();
+    auto retStmt = makeNode<ReturnStatement>(previous());
     retStmt->expression = parseExpression();
     
     if (!match(TokenType::SEMICOLON)) {
@@ -378,7 +405,7 @@ ASTNodePtr Parser::parseLogicalOr() {
     auto left = parseLogicalAnd();
     
     while (match({TokenType::LOGICAL_OR, TokenType::OR, TokenType::EITHER})) {
-        auto op = std::make_shared<BinaryOp>();
+        auto op = makeNode<BinaryOp>(previous());
         op->operation = "||";
         op->left = left;
         op->right = parseLogicalAnd();
@@ -392,7 +419,7 @@ ASTNodePtr Parser::parseLogicalAnd() {
     auto left = parseEquality();
     
     while (match({TokenType::LOGICAL_AND, TokenType::AND, TokenType::JOIN})) {
-        auto op = std::make_shared<BinaryOp>();
+        auto op = makeNode<BinaryOp>(previous());
         op->operation = "&&";
         op->left = left;
         op->right = parseEquality();
@@ -406,9 +433,9 @@ ASTNodePtr Parser::parseEquality() {
     auto left = parseComparison();
     
     while (match(TokenType::EQUAL) || match(TokenType::NOT_EQUAL)) {
-        Token op = tokens[current - 1];
-        auto opNode = std::make_shared<BinaryOp>();
-        opNode->operation = (op.type == TokenType::EQUAL) ? "==" : "!=";
+        TokenType op = previous().type;
+        auto opNode = makeNode<BinaryOp>(previous());
+        opNode->operation = (op == TokenType::EQUAL) ? "==" : "!=";
         opNode->left = left;
         opNode->right = parseComparison();
         left = opNode;
@@ -421,9 +448,9 @@ ASTNodePtr Parser::parseComparison() {
     auto left = parseAddition();
     
     while (match({TokenType::LESS, TokenType::LESS_EQUAL, TokenType::GREATER, TokenType::GREATER_EQUAL})) {
-        Token op = tokens[current - 1];
-        auto opNode = std::make_shared<BinaryOp>();
-        switch (op.type) {
+        TokenType op = previous().type;
+        auto opNode = makeNode<BinaryOp>(previous());
+        switch (op) {
             case TokenType::LESS: opNode->operation = "<"; break;
             case TokenType::LESS_EQUAL: opNode->operation = "<="; break;
             case TokenType::GREATER: opNode->operation = ">"; break;
@@ -442,9 +469,9 @@ ASTNodePtr Parser::parseAddition() {
     auto left = parseMultiplication();
     
     while (match(TokenType::PLUS) || match(TokenType::MINUS)) {
-        Token op = tokens[current - 1];
-        auto opNode = std::make_shared<BinaryOp>();
-        opNode->operation = (op.type == TokenType::PLUS) ? "+" : "-";
+        TokenType op = previous().type;
+        auto opNode = makeNode<BinaryOp>(previous());
+        opNode->operation = (op == TokenType::PLUS) ? "+" : "-";
         opNode->left = left;
         opNode->right = parseMultiplication();
         left = opNode;
@@ -457,9 +484,9 @@ ASTNodePtr Parser::parseMultiplication() {
     auto left = parseUnary();
     
     while (match({TokenType::MULTIPLY, TokenType::DIVIDE, TokenType::MODULO, TokenType::POWER})) {
-        Token op = tokens[current - 1];
-        auto opNode = std::make_shared<BinaryOp>();
-        switch (op.type) {
+        TokenType op = previous().type;
+        auto opNode = makeNode<BinaryOp>(previous());
+        switch (op) {
             case TokenType::MULTIPLY: opNode->operation = "*"; break;
             case TokenType::DIVIDE: opNode->operation = "/"; break;
             case TokenType::MODULO: opNode->operation = "%"; break;
@@ -476,9 +503,9 @@ ASTNodePtr Parser::parseMultiplication() {
 
 ASTNodePtr Parser::parseUnary() {
     if (match({TokenType::LOGICAL_NOT, TokenType::NOT, TokenType::VOID_NOT, TokenType::MINUS})) {
-        Token op = tokens[current - 1];
-        auto unary = std::make_shared<UnaryOp>();
-        unary->operation = (op.type == TokenType::MINUS) ? "-" : "!";
+        TokenType op = previous().type;
+        auto unary = makeNode<UnaryOp>(previous());
+        unary->operation = (op == TokenType::MINUS) ? "-" : "!";
         unary->operand = parseUnary();
         return unary;
     }
@@ -488,44 +515,44 @@ ASTNodePtr Parser::parseUnary() {
 
 ASTNodePtr Parser::parsePrimary() {
     if (match(TokenType::NUMBER)) {
-        auto lit = std::make_shared<Literal>();
-        lit->value = tokens[current - 1].value;
+        auto lit = makeNode<Literal>(previous());
+        lit->value = previous().value;
         lit->dataType = "int";
         return lit;
     }
     
     if (match(TokenType::FLOAT_NUMBER)) {
-        auto lit = std::make_shared<Literal>();
-        lit->value = tokens[current - 1].value;
+        auto lit = makeNode<Literal>(previous());
+        lit->value = previous().value;
         lit->dataType = "float";
         return lit;
     }
     
     if (match(TokenType::STRING_LITERAL)) {
-        auto lit = std::make_shared<Literal>();
-        lit->value = tokens[current - 1].value;
+        auto lit = makeNode<Literal>(previous());
+        lit->value = previous().value;
         lit->dataType = "string";
         return lit;
     }
     
     if (match(TokenType::TRUE)) {
-        auto lit = std::make_shared<Literal>();
+        auto lit = makeNode<Literal>(previous());
         lit->value = "true";
         lit->dataType = "bool";
         return lit;
     }
     
     if (match(TokenType::FALSE)) {
-        auto lit = std::make_shared<Literal>();
+        auto lit = makeNode<Literal>(previous());
         lit->value = "false";
         lit->dataType = "bool";
         return lit;
     }
     
     if (match(TokenType::IDENTIFIER)) {
-        Token id = tokens[current - 1];
+        const Token& id = previous();
         validateIdentifier(id.value, id.line, id.column);
-        auto ident = std::make_shared<Identifier>();
+        auto ident = makeNode<Identifier>(id);
         ident->name = id.value;
         return ident;
     }
@@ -544,20 +571,26 @@ ASTNodePtr Parser::parsePrimary() {
 }
 
 ASTNodePtr Parser::parse() {
-    // First, tokenize everything
-    Token token = scanner.nextToken();
-    while (token.type != TokenType::END_OF_FILE) {
-        if (token.type != TokenType::NEWLINE) {  // Skip newlines during tokenization
-            tokens.push_back(token);
-        }
-        token = scanner.nextToken();
+    ASTNodePtr program = parseProgram();
+    
+    // Drain the rest of the input so every scanner error is reported (and
+    // recorded tokens are complete) even if parsing stopped early
+    while (!reachedEnd) {
+        fetchToken();
     }
-    tokens.push_back(token);  // Add EOF token
     
-    // Add scanner errors to parser errors
-    for (auto& err : scanner.getErrors()) {
-        errors.push_back(err);
+    // Scanner errors come first, as they precede parsing conceptually
+    auto scanErrors = scanner.getErrors();
+    errors.insert(errors.begin(), scanErrors.begin(), scanErrors.end());
+    
+    // Type-check a syntactically complete tree, annotating its expressions
+    bool wellFormed = std::none_of(errors.begin(), errors.end(), [](const std::shared_ptr<Error>& e) {
+        return e->type == ErrorType::SCANNER || e->type == ErrorType::PARSER;
+    });
+    if (program && wellFormed) {
+        auto typeErrors = TypeChecker().check(program);
+        errors.insert(errors.end(), typeErrors.begin(), typeErrors.end());
     }
     
-    return parseProgram();
+    return program;
 }
@@ -1,60 +1,118 @@
 #include "../include/scanner.h"
 #include <cctype>
-#include <algorithm>
 
-Scanner::Scanner(const std::string& src)
-    : source(src), position(0), line(1), column(1) {
-    initializeKeywords();
+// Keyword classification: a switch on length and first character narrows each
+// word to at most two candidates, which are compared case-insensitively in
+// place. No table to build and no lowercase copy of the identifier.
+static constexpr char toLowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+static constexpr bool equalsIgnoreCase(std::string_view word, std::string_view keyword) {
+    if (word.size() != keyword.size()) return false;
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (toLowerAscii(word[i]) != keyword[i]) return false;
+    }
+    return true;
 }
 
-void Scanner::initializeKeywords() {
-    keywords = {
-        {"func", TokenType::FUNC},
-        {"var", TokenType::VAR},
-        {"const", TokenType::CONST},
-        {"return", TokenType::RETURN},
-        {"if", TokenType::IF},
-        {"else", TokenType::ELSE},
-        {"while", TokenType::WHILE},
-        {"for", TokenType::FOR},
-        {"do", TokenType::DO},
-        {"break", TokenType::BREAK},
-        {"continue", TokenType::CONTINUE},
-        {"switch", TokenType::SWITCH},
-        {"case", TokenType::CASE},
-        {"default", TokenType::DEFAULT},
-        {"input", TokenType::INPUT},
-        {"output", TokenType::OUTPUT},
-        {"int", TokenType::INT},
-        {"float", TokenType::FLOAT},
-        {"bool", TokenType::BOOL},
-        {"string", TokenType::STRING},
-        {"true", TokenType::TRUE},
-        {"false", TokenType::FALSE},
-        {"and", TokenType::AND},
-        {"or", TokenType::OR},
-        {"not", TokenType::NOT},
-        {"main", TokenType::MAIN},
-        {"end", TokenType::END},
-        // New syntax keywords
-        {"nexus", TokenType::NEXUS},
-        {"shard", TokenType::SHARD},
-        {"core", TokenType::CORE},
-        {"flux", TokenType::FLUX},
-        {"sig", TokenType::SIG},
-        {"glyph", TokenType::GLYPH},
-        {"probe", TokenType::PROBE},
-        {"fallback", TokenType::FALLBACK},
-        {"pulse", TokenType::PULSE},
-        {"cycle", TokenType::CYCLE},
-        {"listen", TokenType::LISTEN},
-        {"broadcast", TokenType::BROADCAST},
-        {"join", TokenType::JOIN},
-        {"either", TokenType::EITHER},
-        {"void", TokenType::VOID_NOT}
-    };
+static constexpr TokenType keyword(std::string_view word, std::string_view candidate, TokenType type) {
+    return equalsIgnoreCase(word, candidate) ? type : TokenType::IDENTIFIER;
+}
+
+static constexpr TokenType lookupKeyword(std::string_view word) {
+    if (word.empty()) return TokenType::IDENTIFIER;
+    
+    switch (word.size()) {
+        case 2:
+            switch (toLowerAscii(word[0])) {
+                case 'i': return keyword(word, "if", TokenType::IF);
+                case 'd': return keyword(word, "do", TokenType::DO);
+                case 'o': return keyword(word, "or", TokenType::OR);
+            }
+            break;
+        case 3:
+            switch (toLowerAscii(word[0])) {
+                case 'v': return keyword(word, "var", TokenType::VAR);
+                case 'f': return keyword(word, "for", TokenType::FOR);
+                case 'i': return keyword(word, "int", TokenType::INT);
+                case 'a': return keyword(word, "and", TokenType::AND);
+                case 'n': return keyword(word, "not", TokenType::NOT);
+                case 'e': return keyword(word, "end", TokenType::END);
+                case 's': return keyword(word, "sig", TokenType::SIG);
+            }
+            break;
+        case 4:
+            switch (toLowerAscii(word[0])) {
+                case 'f':
+                    if (equalsIgnoreCase(word, "func")) return TokenType::FUNC;
+                    return keyword(word, "flux", TokenType::FLUX);
+                case 'c':
+                    if (equalsIgnoreCase(word, "case")) return TokenType::CASE;
+                    return keyword(word, "core", TokenType::CORE);
+                case 'e': return keyword(word, "else", TokenType::ELSE);
+                case 'b': return keyword(word, "bool", TokenType::BOOL);
+                case 't': return keyword(word, "true", TokenType::TRUE);
+                case 'm': return keyword(word, "main", TokenType::MAIN);
+                case 'j': return keyword(word, "join", TokenType::JOIN);
+                case 'v': return keyword(word, "void", TokenType::VOID_NOT);
+            }
+            break;
+        case 5:
+            switch (toLowerAscii(word[0])) {
+                case 'c':
+                    if (equalsIgnoreCase(word, "const")) return TokenType::CONST;
+                    return keyword(word, "cycle", TokenType::CYCLE);
+                case 'f':
+                    if (equalsIgnoreCase(word, "float")) return TokenType::FLOAT;
+                    return keyword(word, "false", TokenType::FALSE);
+                case 'p':
+                    if (equalsIgnoreCase(word, "probe")) return TokenType::PROBE;
+                    return keyword(word, "pulse", TokenType::PULSE);
+                case 'w': return keyword(word, "while", TokenType::WHILE);
+                case 'b': return keyword(word, "break", TokenType::BREAK);
+                case 'i': return keyword(word, "input", TokenType::INPUT);
+                case 'n': return keyword(word, "nexus", TokenType::NEXUS);
+                case 's': return keyword(word, "shard", TokenType::SHARD);
+                case 'g': return keyword(word, "glyph", TokenType::GLYPH);
+            }
+            break;
+        case 6:
+            switch (toLowerAscii(word[0])) {
+                case 's':
+                    if (equalsIgnoreCase(word, "switch")) return TokenType::SWITCH;
+                    return keyword(word, "string", TokenType::STRING);
+                case 'r': return keyword(word, "return", TokenType::RETURN);
+                case 'o': return keyword(word, "output", TokenType::OUTPUT);
+                case 'l': return keyword(word, "listen", TokenType::LISTEN);
+                case 'e': return keyword(word, "either", TokenType::EITHER);
+            }
+            break;
+        case 7:
+            return keyword(word, "default", TokenType::DEFAULT);
+        case 8:
+            switch (toLowerAscii(word[0])) {
+                case 'c': return keyword(word, "continue", TokenType::CONTINUE);
+                case 'f': return keyword(word, "fallback", TokenType::FALLBACK);
+            }
+            break;
+        case 9:
+            return keyword(word, "broadcast", TokenType::BROADCAST);
+    }
+    return TokenType::IDENTIFIER;
 }
 
+static_assert(lookupKeyword("nexus") == TokenType::NEXUS, "keyword lookup");
+static_assert(lookupKeyword("PuLsE") == TokenType::PULSE, "keyword lookup is case-insensitive");
+static_assert(lookupKeyword("pulses") == TokenType::IDENTIFIER, "keyword lookup matches whole words");
+static_assert(lookupKeyword("fluz") == TokenType::IDENTIFIER, "keyword lookup rejects near misses");
+
+Scanner::Scanner(const std::string& src)
+    : Scanner(SourceBuffer::fromString(src)) {}
+
+Scanner::Scanner(std::shared_ptr<const SourceBuffer> src)
+    : buffer(std::move(src)), source(buffer->view()), position(0), line(1), column(1) {}
+
 char Scanner::currentChar() {
     if (position >= source.length()) return '\0';
     return source[position];
@@ -91,25 +149,41 @@ void Scanner::skipComment() {
     }
 }
 
+std::string_view Scanner::slice(size_t start) const {
+    return source.substr(start, position - start);
+}
+
 Token Scanner::scanString() {
     int startCol = column;
     advance(); // skip opening quote
-    std::string value;
+    size_t start = position;
     
-    while (currentChar() != '"' && currentChar() != '\0') {
-        if (currentChar() == '\\') {
-            advance();
-            switch (currentChar()) {
-                case 'n': value += '\n'; break;
-                case 't': value += '\t'; break;
-                case '\\': value += '\\'; break;
-                case '"': value += '"'; break;
-                default: value += currentChar();
+    // Fast path: literals without escapes are returned as a view of the source
+    while (currentChar() != '"' && currentChar() != '\0' && currentChar() != '\\') {
+        advance();
+    }
+    std::string_view value = slice(start);
+    
+    if (currentChar() == '\\') {
+        // Escapes need a materialized copy that outlives this call
+        std::string unescaped(value);
+        while (currentChar() != '"' && currentChar() != '\0') {
+            if (currentChar() == '\\') {
+                advance();
+                switch (currentChar()) {
+                    case 'n': unescaped += '\n'; break;
+                    case 't': unescaped += '\t'; break;
+                    case '\\': unescaped += '\\'; break;
+                    case '"': unescaped += '"'; break;
+                    default: unescaped += currentChar();
+                }
+            } else {
+                unescaped += currentChar();
             }
-        } else {
-            value += currentChar();
+            advance();
         }
-        advance();
+        materializedStrings.push_back(std::move(unescaped));
+        value = materializedStrings.back();
     }
     
     if (currentChar() == '"') {
@@ -125,45 +199,33 @@ Token Scanner::scanString() {
 
 Token Scanner::scanNumber() {
     int startCol = column;
-    std::string value;
+    size_t start = position;
     
     while (std::isdigit(currentChar())) {
-        value += currentChar();
         advance();
     }
     
     if (currentChar() == '.' && std::isdigit(peekChar())) {
-        value += '.';
         advance();
         while (std::isdigit(currentChar())) {
-            value += currentChar();
             advance();
         }
-        return Token(TokenType::FLOAT_NUMBER, value, line, startCol);
+        return Token(TokenType::FLOAT_NUMBER, slice(start), line, startCol);
     }
     
-    return Token(TokenType::NUMBER, value, line, startCol);
+    return Token(TokenType::NUMBER, slice(start), line, startCol);
 }
 
 Token Scanner::scanIdentifierOrKeyword() {
     int startCol = column;
-    std::string value;
+    size_t start = position;
     
     while (std::isalnum(currentChar()) || currentChar() == '_') {
-        value += currentChar();
         advance();
     }
+    std::string_view value = slice(start);
     
-    // Convert to lowercase for keyword matching
-    std::string lowerValue = value;
-    std::transform(lowerValue.begin(), lowerValue.end(), lowerValue.begin(), ::tolower);
-    
-    auto it = keywords.find(lowerValue);
-    if (it != keywords.end()) {
-        return Token(it->second, value, line, startCol);
-    }
-    
-    return Token(TokenType::IDENTIFIER, value, line, startCol);
+    return Token(lookupKeyword(value), value, line, startCol);
 }
 
 Token Scanner::scanOperatorOrPunctuation() {
@@ -288,13 +350,15 @@ Token Scanner::scanOperatorOrPunctuation() {
         case '?':
             advance();
             return Token(TokenType::QUESTION, "?", line, startCol);
-        default:
+        default: {
+            size_t start = position;
             advance();
             errors.push_back(std::make_shared<Error>(
                 std::string("Illegal character '") + current + "'",
                 line, startCol, ErrorType::SCANNER
             ));
-            return Token(TokenType::ERROR_TOKEN, std::string(1, current), line, startCol);
+            return Token(TokenType::ERROR_TOKEN, slice(start), line, startCol);
+        }
     }
 }
 
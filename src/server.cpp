@@ -0,0 +1,143 @@
+#include "../include/server.h"
+#include "../include/driver.h"
+#include "../include/compile_cache.h"
+#include <json/json.h>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// Serialized result members, shared between the cache and responses
+using ResultCache = CompileCache<std::shared_ptr<const std::string>>;
+
+// Cache option bit for -O, above the EmitSection bits
+static constexpr unsigned OPTION_OPTIMIZE = 1u << 16;
+
+static void writeErrorResponse(JsonWriter& json, const Json::Value& id, const std::string& message) {
+    json.beginObject();
+    json.key("id").value(id);
+    json.key("error").value(message);
+    json.endObject();
+}
+
+// The members of a compile result, rendered once so a cache hit can be
+// replayed without scanning or parsing
+static std::shared_ptr<const std::string> renderCompileResult(const std::string& code, bool optimizeAst,
+                                                              unsigned emit) {
+    std::ostringstream text;
+    {
+        JsonWriter result(text);
+        result.beginObject();
+        writeCompileResult(result, SourceBuffer::fromString(code), optimizeAst, emit);
+        result.endObject();
+    }
+    std::string object = text.str();
+    return std::make_shared<const std::string>(object.substr(1, object.size() - 2));
+}
+
+static void handleRequest(const Json::Value& request, JsonWriter& json, ResultCache& cache, bool& shutdown) {
+    if (!request.isObject()) {
+        writeErrorResponse(json, Json::Value(), "Request must be a JSON object");
+        return;
+    }
+    
+    const Json::Value& id = request["id"];
+    
+    if (request.isMember("cmd")) {
+        std::string cmd = request["cmd"].asString();
+        if (cmd == "shutdown") {
+            shutdown = true;
+            json.beginObject();
+            json.key("id").value(id);
+            json.key("ok").value(true);
+            json.endObject();
+            return;
+        }
+        if (cmd == "stats") {
+            json.beginObject();
+            json.key("id").value(id);
+            json.key("cache").beginObject();
+            json.key("hits").value(cache.getHits());
+            json.key("misses").value(cache.getMisses());
+            json.key("entries").value(static_cast<uint64_t>(cache.size()));
+            json.key("bytes").value(static_cast<uint64_t>(cache.getBytes()));
+            json.key("maxBytes").value(static_cast<uint64_t>(cache.getMaxBytes()));
+            json.endObject();
+            json.endObject();
+            return;
+        }
+        writeErrorResponse(json, id, "Unknown command '" + cmd + "'");
+        return;
+    }
+    
+    if (!request["code"].isString()) {
+        writeErrorResponse(json, id, "Missing \"code\" field in request");
+        return;
+    }
+    
+    // "emit": ["errors", ...] or "errors,..." selects the sections, as --emit= does
+    unsigned emit = EMIT_ALL;
+    const Json::Value& sections = request["emit"];
+    try {
+        if (sections.isString()) {
+            emit = parseEmitSections(sections.asString());
+        } else if (sections.isArray()) {
+            emit = 0;
+            for (const Json::Value& section : sections) {
+                if (!section.isString()) throw std::runtime_error("\"emit\" sections must be strings");
+                emit |= parseEmitSections(section.asString());
+            }
+        } else if (!sections.isNull()) {
+            throw std::runtime_error("\"emit\" must be a string or an array of strings");
+        }
+    } catch (const std::runtime_error& e) {
+        writeErrorResponse(json, id, e.what());
+        return;
+    }
+    
+    bool optimizeAst = request["optimize"].isBool() && request["optimize"].asBool();
+    const std::string code = request["code"].asString();
+    unsigned options = emit | (optimizeAst ? OPTION_OPTIMIZE : 0);
+    std::shared_ptr<const std::string> result;
+    if (auto cached = cache.find(code, options)) {
+        result = *cached;
+    } else {
+        result = renderCompileResult(code, optimizeAst, emit);
+        cache.insert(code, options, result, result->size());
+    }
+    
+    json.beginObject();
+    json.key("id").value(id);
+    json.members(*result);
+    json.endObject();
+}
+
+int runServer(std::istream& in, std::ostream& out, size_t cacheBytes) {
+    Json::CharReaderBuilder readerBuilder;
+    std::unique_ptr<Json::CharReader> reader(readerBuilder.newCharReader());
+    
+    // Responses are compact, so each fits on one line
+    JsonWriter json(out);
+    ResultCache cache(cacheBytes);
+    std::string line;
+    bool shutdown = false;
+    while (!shutdown && std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        
+        Json::Value request;
+        std::string parseErrors;
+        if (reader->parse(line.data(), line.data() + line.size(), &request, &parseErrors)) {
+            handleRequest(request, json, cache, shutdown);
+        } else {
+            writeErrorResponse(json, Json::Value(), "Malformed request: " + parseErrors);
+        }
+        
+        // Flush so the client never waits on buffering
+        json.flush();
+        out << '\n';
+        out.flush();
+    }
+    
+    return 0;
+}
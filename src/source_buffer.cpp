@@ -0,0 +1,61 @@
+#include "../include/source_buffer.h"
+#include <fstream>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SOURCE_BUFFER_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceBuffer::~SourceBuffer() {
+#ifdef SOURCE_BUFFER_HAS_MMAP
+    if (mapped) {
+        munmap(const_cast<char*>(mapped), mappedSize);
+    }
+#endif
+}
+
+std::shared_ptr<const SourceBuffer> SourceBuffer::fromString(std::string text) {
+    std::shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+    buffer->owned = std::move(text);
+    return buffer;
+}
+
+std::shared_ptr<const SourceBuffer> SourceBuffer::fromFile(const std::string& path, std::string& error) {
+#ifdef SOURCE_BUFFER_HAS_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "Could not open file " + path;
+        return nullptr;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        size_t size = static_cast<size_t>(info.st_size);
+        void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            close(fd);
+            // The scanner reads front to back exactly once
+            madvise(addr, size, MADV_SEQUENTIAL);
+            std::shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+            buffer->mapped = static_cast<const char*>(addr);
+            buffer->mappedSize = size;
+            return buffer;
+        }
+    }
+    // Empty files, pipes and mmap failures fall through to a plain read
+    close(fd);
+#endif
+    
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        error = "Could not open file " + path;
+        return nullptr;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return fromString(contents.str());
+}
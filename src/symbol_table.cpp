@@ -23,3 +23,7 @@ std::shared_ptr<Symbol> SymbolTable::getSymbol(const std::string& name) const {
 std::string SymbolTable::getType(const std::string& name) const {
     return getSymbol(name)->type;
 }
+
+void SymbolTable::removeSymbol(const std::string& name) {
+    symbols.erase(name);
+}
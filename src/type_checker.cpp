@@ -0,0 +1,167 @@
+#include "../include/type_checker.h"
+#include <stdexcept>
+
+static bool isNumeric(ValueType type) {
+    return type == ValueType::Int || type == ValueType::Float;
+}
+
+static void collectDeclarations(ASTNodePtr node, std::unordered_map<std::string_view, ValueType>& variables) {
+    if (auto d = nodeAs<Declaration>(node)) {
+        ValueType type = valueTypeFromName(std::string(d->dataType));
+        for (std::string_view name : d->identifiers) variables.emplace(name, type);  // First declaration wins
+    }
+    forEachChild(node, [&variables](ASTNodePtr child) { collectDeclarations(child, variables); });
+}
+
+ValueType checkedType(ASTNodePtr expression) {
+    if (!expression || !expression->valueType) {
+        throw std::runtime_error("Untyped expression; the program has type errors");
+    }
+    return *expression->valueType;
+}
+
+std::vector<std::shared_ptr<Error>> TypeChecker::check(ASTNodePtr program) {
+    variables.clear();
+    errors.clear();
+    if (program) {
+        collectDeclarations(program, variables);
+        visit(program);
+    }
+    return std::move(errors);
+}
+
+void TypeChecker::error(const std::string& message, ASTNodePtr at) {
+    errors.push_back(std::make_shared<Error>(message, at->line, at->column, ErrorType::SEMANTIC));
+}
+
+// Type of an expression, annotating it; nullopt for a missing expression
+std::optional<ValueType> TypeChecker::typeOf(ASTNodePtr expression) {
+    if (!expression) return std::nullopt;
+    std::optional<ValueType> type = visit(expression);
+    expression->valueType = type;
+    return type;
+}
+
+void TypeChecker::checkBlock(const ASTNodeList& statements) {
+    for (ASTNodePtr stmt : statements) {
+        if (stmt) visit(stmt);
+    }
+}
+
+void TypeChecker::checkStore(ASTNodePtr value, ValueType target, std::string_view name, ASTNodePtr at) {
+    std::optional<ValueType> type = typeOf(value);
+    if (!type || *type == target || (isNumeric(*type) && isNumeric(target))) return;
+
+    error(std::string("Cannot assign ") + valueTypeToString(*type) + " to " + valueTypeToString(target) +
+          " variable '" + std::string(name) + "'", at);
+}
+
+std::optional<ValueType> TypeChecker::visitProgram(Program* p) {
+    checkBlock(p->declarations);
+    checkBlock(p->statements);
+    return std::nullopt;
+}
+
+std::optional<ValueType> TypeChecker::visitDeclaration(Declaration* d) {
+    ValueType type = valueTypeFromName(std::string(d->dataType));
+    for (size_t i = 0; i < d->identifiers.size() && i < d->initializers.size(); ++i) {
+        ASTNodePtr init = d->initializers[i];
+        if (init) checkStore(init, type, d->identifiers[i], init);
+    }
+    return std::nullopt;
+}
+
+std::optional<ValueType> TypeChecker::visitAssignment(Assignment* a) {
+    auto it = variables.find(a->identifier);
+    if (it == variables.end()) {
+        typeOf(a->expression);  // Undeclared target: reported by the parser
+    } else {
+        checkStore(a->expression, it->second, a->identifier, a);
+    }
+    return std::nullopt;
+}
+
+std::optional<ValueType> TypeChecker::visitBinaryOp(BinaryOp* b) {
+    std::string_view op = b->operation;
+    std::optional<ValueType> left = typeOf(b->left);
+    std::optional<ValueType> right = typeOf(b->right);
+
+    // Operands are only tested for truthiness
+    if (op == "&&" || op == "||") return ValueType::Bool;
+    if (!left || !right) return std::nullopt;
+
+    ValueType lt = *left, rt = *right;
+    bool bothNumeric = isNumeric(lt) && isNumeric(rt);
+
+    if (op == "+" && (lt == ValueType::String || rt == ValueType::String)) return ValueType::String;
+
+    if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%" || op == "**") {
+        if (bothNumeric) return (lt == ValueType::Int && rt == ValueType::Int) ? ValueType::Int : ValueType::Float;
+    } else if (bothNumeric || lt == rt || op == "==" || op == "!=") {
+        return ValueType::Bool;
+    }
+
+    error("Operator '" + std::string(op) + "' cannot be applied to " + valueTypeToString(lt) + " and " +
+          valueTypeToString(rt), b);
+    return std::nullopt;
+}
+
+std::optional<ValueType> TypeChecker::visitUnaryOp(UnaryOp* u) {
+    std::optional<ValueType> operand = typeOf(u->operand);
+
+    if (u->operation == "!") return ValueType::Bool;
+    if (!operand) return std::nullopt;
+    if (isNumeric(*operand)) return operand;
+
+    error(std::string("Operator '-' cannot be applied to ") + valueTypeToString(*operand), u);
+    return std::nullopt;
+}
+
+std::optional<ValueType> TypeChecker::visitLiteral(Literal* l) {
+    if (l->dataType == "int") {
+        try {
+            std::stoll(std::string(l->value));
+        } catch (const std::out_of_range&) {
+            error("Integer literal '" + std::string(l->value) + "' out of range", l);
+            return std::nullopt;
+        }
+    }
+    return valueTypeFromName(std::string(l->dataType));
+}
+
+std::optional<ValueType> TypeChecker::visitIdentifier(Identifier* id) {
+    auto it = variables.find(id->name);
+    if (it == variables.end()) return std::nullopt;  // Reported by the parser
+    return it->second;
+}
+
+std::optional<ValueType> TypeChecker::visitFunctionCall(FunctionCall* f) {
+    for (ASTNodePtr argument : f->arguments) typeOf(argument);
+    return std::nullopt;
+}
+
+std::optional<ValueType> TypeChecker::visitIfStatement(IfStatement* iff) {
+    typeOf(iff->condition);  // Any type: conditions test truthiness
+    checkBlock(iff->thenBranch);
+    checkBlock(iff->elseBranch);
+    return std::nullopt;
+}
+
+std::optional<ValueType> TypeChecker::visitWhileLoop(WhileLoop* w) {
+    typeOf(w->condition);
+    checkBlock(w->body);
+    return std::nullopt;
+}
+
+std::optional<ValueType> TypeChecker::visitForLoop(ForLoop* f) {
+    if (f->initialization) visit(f->initialization);
+    typeOf(f->condition);
+    typeOf(f->increment);
+    checkBlock(f->body);
+    return std::nullopt;
+}
+
+std::optional<ValueType> TypeChecker::visitReturnStatement(ReturnStatement* r) {
+    typeOf(r->expression);
+    return std::nullopt;
+}
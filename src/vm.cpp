@@ -0,0 +1,569 @@
+#include "../include/vm.h"
+#include "../include/int_arith.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Threaded dispatch needs the labels-as-values extension (GCC and Clang).
+// Define VM_THREADED_DISPATCH=0 to make the portable switch loop the default.
+#if defined(__GNUC__)
+#define VM_HAS_COMPUTED_GOTO 1
+#else
+#define VM_HAS_COMPUTED_GOTO 0
+#endif
+
+#ifndef VM_THREADED_DISPATCH
+#define VM_THREADED_DISPATCH VM_HAS_COMPUTED_GOTO
+#endif
+
+static bool isNumeric(const Value& v) {
+    return v.type == ValueType::Int || v.type == ValueType::Float;
+}
+
+static double toDouble(const Value& v) {
+    return v.type == ValueType::Int ? static_cast<double>(v.i) : v.f;
+}
+
+static bool isTruthy(const Value& v) {
+    switch (v.type) {
+        case ValueType::Int: return v.i != 0;
+        case ValueType::Float: return v.f != 0.0;
+        case ValueType::Bool: return v.b;
+        case ValueType::String: return !v.s->empty();
+    }
+    return false;
+}
+
+static const char* operatorSymbol(OpCode op) {
+    switch (op) {
+        case OpCode::Add: return "+";
+        case OpCode::Sub: return "-";
+        case OpCode::Mul: return "*";
+        case OpCode::Div: return "/";
+        case OpCode::Mod: return "%";
+        case OpCode::Pow: return "**";
+        case OpCode::Equal: return "==";
+        case OpCode::NotEqual: return "!=";
+        case OpCode::Less: return "<";
+        case OpCode::LessEqual: return "<=";
+        case OpCode::Greater: return ">";
+        case OpCode::GreaterEqual: return ">=";
+        default: return "?";
+    }
+}
+
+template <typename T>
+static bool compare(OpCode op, const T& a, const T& b) {
+    switch (op) {
+        case OpCode::Equal: return a == b;
+        case OpCode::NotEqual: return a != b;
+        case OpCode::Less: return a < b;
+        case OpCode::LessEqual: return a <= b;
+        case OpCode::Greater: return a > b;
+        default: return a >= b;
+    }
+}
+
+VM::VM(const Chunk& c, std::istream& input, std::ostream& output)
+    : chunk(c), in(input), out(output) {}
+
+bool VM::fail(const std::string& message) {
+    error = std::make_shared<Error>(message, 0, 0, ErrorType::RUNTIME);
+    return false;
+}
+
+const std::string* VM::newString(std::string text) {
+    strings.push_back(std::move(text));
+    return &strings.back();
+}
+
+// Generic binary operator: computes `left op right` into `left`
+bool VM::binary(OpCode op, Value& left, const Value& right) {
+    bool bothInt = left.type == ValueType::Int && right.type == ValueType::Int;
+
+    switch (op) {
+        case OpCode::Add:
+            if (left.type == ValueType::String || right.type == ValueType::String) {
+                left = Value::ofString(newString(valueToString(left) + valueToString(right)));
+                return true;
+            }
+            // fallthrough
+        case OpCode::Sub:
+        case OpCode::Mul:
+        case OpCode::Div:
+        case OpCode::Mod:
+        case OpCode::Pow:
+            if (!isNumeric(left) || !isNumeric(right)) break;
+
+            if (bothInt) {
+                int64_t a = left.i, b = right.i;
+                switch (op) {
+                    case OpCode::Add: left.i = wrapAdd(a, b); return true;
+                    case OpCode::Sub: left.i = wrapSub(a, b); return true;
+                    case OpCode::Mul: left.i = wrapMul(a, b); return true;
+                    case OpCode::Div:
+                        if (b == 0) return fail("Division by zero");
+                        left.i = wrapDiv(a, b);
+                        return true;
+                    case OpCode::Mod:
+                        if (b == 0) return fail("Modulo by zero");
+                        left.i = wrapMod(a, b);
+                        return true;
+                    default:
+                        if (a == 0 && b < 0) return fail("Division by zero");
+                        left.i = intPow(a, b);
+                        return true;
+                }
+            }
+
+            {
+                double a = toDouble(left), b = toDouble(right);
+                double r;
+                switch (op) {
+                    case OpCode::Add: r = a + b; break;
+                    case OpCode::Sub: r = a - b; break;
+                    case OpCode::Mul: r = a * b; break;
+                    case OpCode::Div: r = a / b; break;
+                    case OpCode::Mod: r = std::fmod(a, b); break;
+                    default: r = std::pow(a, b); break;
+                }
+                left = Value::ofFloat(r);
+            }
+            return true;
+
+        default: {
+            // Comparisons
+            bool result;
+            if (bothInt) {
+                result = compare(op, left.i, right.i);
+            } else if (isNumeric(left) && isNumeric(right)) {
+                result = compare(op, toDouble(left), toDouble(right));
+            } else if (left.type == ValueType::String && right.type == ValueType::String) {
+                result = compare(op, *left.s, *right.s);
+            } else if (left.type == ValueType::Bool && right.type == ValueType::Bool) {
+                result = compare(op, left.b, right.b);
+            } else if (op == OpCode::Equal || op == OpCode::NotEqual) {
+                result = (op == OpCode::NotEqual);  // Values of different types are never equal
+            } else {
+                break;
+            }
+            left = Value::ofBool(result);
+            return true;
+        }
+    }
+
+    return fail(std::string("Operator '") + operatorSymbol(op) + "' cannot be applied to " +
+                valueTypeToString(left.type) + " and " + valueTypeToString(right.type));
+}
+
+// Stores convert numbers to the variable's declared type (float -> int
+// truncates, and fails outside the int range)
+bool VM::store(int32_t slot, const Value& value) {
+    ValueType target = chunk.slotTypes[slot];
+    Value& dest = slots[slot];
+
+    if (value.type == target) {
+        dest = value;
+    } else if (target == ValueType::Float && value.type == ValueType::Int) {
+        dest = Value::ofFloat(static_cast<double>(value.i));
+    } else if (target == ValueType::Int && value.type == ValueType::Float) {
+        if (!fitsInt64(value.f)) return fail("Cannot convert " + valueToString(value) + " to int");
+        dest = Value::ofInt(static_cast<int64_t>(value.f));
+    } else {
+        return fail(std::string("Cannot assign ") + valueTypeToString(value.type) + " to " +
+                    valueTypeToString(target) + " variable '" + chunk.slotNames[slot] + "'");
+    }
+    return true;
+}
+
+// `listen`: one line of input, parsed according to the variable's type
+bool VM::read(int32_t slot) {
+    std::string line;
+    if (!std::getline(in, line)) return fail("Unexpected end of input");
+
+    size_t first = line.find_first_not_of(" \t\r");
+    size_t last = line.find_last_not_of(" \t\r");
+    std::string text = (first == std::string::npos) ? "" : line.substr(first, last - first + 1);
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    errno = 0;
+
+    switch (chunk.slotTypes[slot]) {
+        case ValueType::Int: {
+            long long v = std::strtoll(begin, &end, 10);
+            if (text.empty() || *end != '\0' || errno == ERANGE) {
+                return fail("Invalid input: expected integer, got '" + text + "'");
+            }
+            slots[slot] = Value::ofInt(v);
+            return true;
+        }
+        case ValueType::Float: {
+            double v = std::strtod(begin, &end);
+            if (text.empty() || *end != '\0') {
+                return fail("Invalid input: expected float, got '" + text + "'");
+            }
+            slots[slot] = Value::ofFloat(v);
+            return true;
+        }
+        case ValueType::Bool:
+            if (text != "true" && text != "false" && text != "0" && text != "1") {
+                return fail("Invalid input: expected boolean (true/false), got '" + text + "'");
+            }
+            slots[slot] = Value::ofBool(text == "true" || text == "1");
+            return true;
+        case ValueType::String:
+            slots[slot] = Value::ofString(newString(std::move(text)));
+            return true;
+    }
+    return true;
+}
+
+VM::Dispatch VM::defaultDispatch() {
+    return VM_THREADED_DISPATCH ? Dispatch::Threaded : Dispatch::Switch;
+}
+
+bool VM::run() {
+    return run(defaultDispatch());
+}
+
+bool VM::run(Dispatch mode) {
+    static const std::string emptyString;
+
+    error.reset();
+    strings.clear();
+    stack.assign(chunk.maxStack + 1, Value());
+
+    // Every variable holds a value of its declared type from the start, even
+    // if its declaration is skipped (e.g. inside a probe that is not taken)
+    slots.resize(chunk.slotTypes.size());
+    for (size_t i = 0; i < slots.size(); ++i) {
+        switch (chunk.slotTypes[i]) {
+            case ValueType::Int: slots[i] = Value::ofInt(0); break;
+            case ValueType::Float: slots[i] = Value::ofFloat(0.0); break;
+            case ValueType::Bool: slots[i] = Value::ofBool(false); break;
+            case ValueType::String: slots[i] = Value::ofString(&emptyString); break;
+        }
+    }
+
+    if (profiling) {
+        stats.executed.assign(OPCODE_COUNT, 0);
+#if VM_HAS_COMPUTED_GOTO
+        if (mode == Dispatch::Threaded) return execute<true, true>();
+#endif
+        return execute<false, true>();
+    }
+
+#if VM_HAS_COMPUTED_GOTO
+    if (mode == Dispatch::Threaded) return execute<true, false>();
+#else
+    (void)mode;
+#endif
+    return execute<false, false>();
+}
+
+// The interpreter loop, written once for both dispatch strategies.
+// VM_TARGET marks a handler: a switch case that, with computed goto, is also
+// a label. VM_NEXT ends a handler: the threaded build jumps straight to the
+// next instruction's handler address; the switch build loops back to the
+// switch. Handlers must not declare variables outside a nested block, since
+// the threaded build jumps into the middle of the switch. VM_COUNT records
+// the instruction about to run when profiling.
+#define VM_COUNT \
+    if constexpr (Profile) ++counts[static_cast<size_t>(ins->op)]
+#if VM_HAS_COMPUTED_GOTO
+#define VM_TARGET(name) case OpCode::name: op_##name
+#define VM_NEXT \
+    if constexpr (Threaded) { ins = &code[pc]; VM_COUNT; goto *threaded[pc++]; } else continue
+#else
+#define VM_TARGET(name) case OpCode::name
+#define VM_NEXT continue
+#endif
+
+template <bool Threaded, bool Profile>
+bool VM::execute() {
+    const Instruction* code = chunk.code.data();
+    const Value* constants = chunk.constants.data();
+    Value* sp = stack.data();  // Next free stack entry
+    size_t pc = 0;
+    const Instruction* ins;
+    uint64_t* counts = stats.executed.data();
+    (void)counts;
+
+#if VM_HAS_COMPUTED_GOTO
+    // Handler addresses in OpCode order
+    static const void* const labels[] = {
+        &&op_PushConst, &&op_Load, &&op_Store, &&op_Pop,
+        &&op_Add, &&op_Sub, &&op_Mul, &&op_Div, &&op_Mod, &&op_Pow,
+        &&op_Neg, &&op_Not,
+        &&op_Equal, &&op_NotEqual, &&op_Less, &&op_LessEqual, &&op_Greater, &&op_GreaterEqual,
+        &&op_Jump, &&op_JumpIfFalse, &&op_JumpIfTrue,
+        &&op_Print, &&op_Read, &&op_Halt,
+        &&op_IncLocal, &&op_CmpLocalConstJump, &&op_PrintLocal,
+        &&op_AddInt, &&op_SubInt, &&op_MulInt, &&op_DivInt, &&op_ModInt,
+        &&op_AddFloat, &&op_SubFloat, &&op_MulFloat, &&op_DivFloat,
+        &&op_NegInt, &&op_NegFloat, &&op_NotBool, &&op_ToFloat,
+        &&op_CompareInt, &&op_CompareFloat, &&op_StoreDirect,
+        &&op_JumpIfFalseBool, &&op_JumpIfTrueBool, &&op_CmpIntJump,
+        &&op_IncLocalInt, &&op_CmpLocalConstJumpInt
+    };
+    static_assert(sizeof(labels) / sizeof(labels[0]) == OPCODE_COUNT, "labels must list every OpCode");
+
+    // Direct threading: translate the program once into handler addresses so
+    // each dispatch is a single indirect jump with no opcode decoding
+    std::vector<const void*> threaded;
+    if constexpr (Threaded) {
+        threaded.resize(chunk.code.size());
+        for (size_t i = 0; i < threaded.size(); ++i) {
+            threaded[i] = labels[static_cast<size_t>(code[i].op)];
+        }
+        ins = &code[pc];
+        VM_COUNT;
+        goto *threaded[pc++];
+    }
+#endif
+
+    for (;;) {
+        ins = &code[pc++];
+        VM_COUNT;
+
+        switch (ins->op) {
+            VM_TARGET(PushConst):
+                *sp++ = constants[ins->a];
+                VM_NEXT;
+
+            VM_TARGET(Load):
+                *sp++ = slots[ins->a];
+                VM_NEXT;
+
+            VM_TARGET(Store):
+                if (!store(ins->a, *--sp)) return false;
+                VM_NEXT;
+
+            VM_TARGET(Pop):
+                --sp;
+                VM_NEXT;
+
+            VM_TARGET(Add):
+            VM_TARGET(Sub):
+            VM_TARGET(Mul):
+            VM_TARGET(Div):
+            VM_TARGET(Mod):
+            VM_TARGET(Pow):
+            VM_TARGET(Equal):
+            VM_TARGET(NotEqual):
+            VM_TARGET(Less):
+            VM_TARGET(LessEqual):
+            VM_TARGET(Greater):
+            VM_TARGET(GreaterEqual):
+                --sp;
+                if (!binary(ins->op, sp[-1], *sp)) return false;
+                VM_NEXT;
+
+            VM_TARGET(Neg): {
+                Value& v = sp[-1];
+                if (v.type == ValueType::Int) v.i = wrapSub(0, v.i);
+                else if (v.type == ValueType::Float) v.f = -v.f;
+                else return fail(std::string("Operator '-' cannot be applied to ") + valueTypeToString(v.type));
+                VM_NEXT;
+            }
+
+            VM_TARGET(Not):
+                sp[-1] = Value::ofBool(!isTruthy(sp[-1]));
+                VM_NEXT;
+
+            VM_TARGET(Jump):
+                pc = ins->a;
+                VM_NEXT;
+
+            VM_TARGET(JumpIfFalse):
+                if (!isTruthy(*--sp)) pc = ins->a;
+                VM_NEXT;
+
+            VM_TARGET(JumpIfTrue):
+                if (isTruthy(*--sp)) pc = ins->a;
+                VM_NEXT;
+
+            VM_TARGET(Print):
+                out << valueToString(*--sp) << '\n';
+                VM_NEXT;
+
+            VM_TARGET(Read):
+                if (!read(ins->a)) return false;
+                VM_NEXT;
+
+            VM_TARGET(Halt):
+                out.flush();
+                return true;
+
+            VM_TARGET(IncLocal): {
+                Value& v = slots[ins->a];
+                const Value& step = constants[ins->b];
+                if (v.type == ValueType::Int && step.type == ValueType::Int) {
+                    v.i = wrapAdd(v.i, step.i);
+                } else {
+                    Value sum = v;
+                    if (!binary(OpCode::Add, sum, step) || !store(ins->a, sum)) return false;
+                }
+                VM_NEXT;
+            }
+
+            VM_TARGET(CmpLocalConstJump): {
+                const Value& v = slots[ins->a];
+                const Value& limit = constants[ins->b];
+                bool holds;
+                if (v.type == ValueType::Int && limit.type == ValueType::Int) {
+                    holds = compare(ins->cmp, v.i, limit.i);
+                } else {
+                    Value result = v;
+                    if (!binary(ins->cmp, result, limit)) return false;
+                    holds = result.b;
+                }
+                if (!holds) pc = ins->c;
+                VM_NEXT;
+            }
+
+            VM_TARGET(PrintLocal):
+                out << valueToString(slots[ins->a]) << '\n';
+                VM_NEXT;
+
+            // Type-specialized handlers: operand types are known statically,
+            // so results are written without touching the tags
+            VM_TARGET(AddInt):
+                --sp;
+                sp[-1].i = wrapAdd(sp[-1].i, sp->i);
+                VM_NEXT;
+
+            VM_TARGET(SubInt):
+                --sp;
+                sp[-1].i = wrapSub(sp[-1].i, sp->i);
+                VM_NEXT;
+
+            VM_TARGET(MulInt):
+                --sp;
+                sp[-1].i = wrapMul(sp[-1].i, sp->i);
+                VM_NEXT;
+
+            VM_TARGET(DivInt):
+                --sp;
+                if (sp->i == 0) return fail("Division by zero");
+                sp[-1].i = wrapDiv(sp[-1].i, sp->i);
+                VM_NEXT;
+
+            VM_TARGET(ModInt):
+                --sp;
+                if (sp->i == 0) return fail("Modulo by zero");
+                sp[-1].i = wrapMod(sp[-1].i, sp->i);
+                VM_NEXT;
+
+            VM_TARGET(AddFloat):
+                --sp;
+                sp[-1].f += sp->f;
+                VM_NEXT;
+
+            VM_TARGET(SubFloat):
+                --sp;
+                sp[-1].f -= sp->f;
+                VM_NEXT;
+
+            VM_TARGET(MulFloat):
+                --sp;
+                sp[-1].f *= sp->f;
+                VM_NEXT;
+
+            VM_TARGET(DivFloat):
+                --sp;
+                sp[-1].f /= sp->f;
+                VM_NEXT;
+
+            VM_TARGET(NegInt):
+                sp[-1].i = wrapSub(0, sp[-1].i);
+                VM_NEXT;
+
+            VM_TARGET(NegFloat):
+                sp[-1].f = -sp[-1].f;
+                VM_NEXT;
+
+            VM_TARGET(NotBool):
+                sp[-1].b = !sp[-1].b;
+                VM_NEXT;
+
+            VM_TARGET(ToFloat):
+                sp[-1] = Value::ofFloat(static_cast<double>(sp[-1].i));
+                VM_NEXT;
+
+            VM_TARGET(CompareInt):
+                --sp;
+                sp[-1] = Value::ofBool(compare(ins->cmp, sp[-1].i, sp->i));
+                VM_NEXT;
+
+            VM_TARGET(CompareFloat):
+                --sp;
+                sp[-1] = Value::ofBool(compare(ins->cmp, sp[-1].f, sp->f));
+                VM_NEXT;
+
+            VM_TARGET(StoreDirect):
+                slots[ins->a] = *--sp;
+                VM_NEXT;
+
+            VM_TARGET(JumpIfFalseBool):
+                if (!(--sp)->b) pc = ins->a;
+                VM_NEXT;
+
+            VM_TARGET(JumpIfTrueBool):
+                if ((--sp)->b) pc = ins->a;
+                VM_NEXT;
+
+            VM_TARGET(CmpIntJump):
+                sp -= 2;
+                if (!compare(ins->cmp, sp[0].i, sp[1].i)) pc = ins->a;
+                VM_NEXT;
+
+            VM_TARGET(IncLocalInt): {
+                Value& v = slots[ins->a];
+                v.i = wrapAdd(v.i, constants[ins->b].i);
+                VM_NEXT;
+            }
+
+            VM_TARGET(CmpLocalConstJumpInt):
+                if (!compare(ins->cmp, slots[ins->a].i, constants[ins->b].i)) pc = ins->c;
+                VM_NEXT;
+        }
+    }
+}
+
+#undef VM_COUNT
+#undef VM_TARGET
+#undef VM_NEXT
+
+uint64_t VMStats::total() const {
+    uint64_t sum = 0;
+    for (uint64_t n : executed) sum += n;
+    return sum;
+}
+
+uint64_t VMStats::saved() const {
+    uint64_t sum = 0;
+    for (size_t op = 0; op < executed.size(); ++op) {
+        sum += executed[op] * fusedInstructionSavings(static_cast<OpCode>(op));
+    }
+    return sum;
+}
+
+void VMStats::writeReport(std::ostream& report) const {
+    uint64_t run = total();
+    uint64_t avoided = saved();
+
+    report << "instructions executed: " << run << "\n";
+    for (size_t op = 0; op < executed.size(); ++op) {
+        if (executed[op] == 0) continue;
+        report << "  " << opCodeToString(static_cast<OpCode>(op)) << ": " << executed[op] << "\n";
+    }
+    report << "saved by superinstructions: " << avoided << " of " << run + avoided;
+    if (run + avoided > 0) {
+        char percent[32];
+        std::snprintf(percent, sizeof(percent), " (%.1f%%)", 100.0 * avoided / (run + avoided));
+        report << percent;
+    }
+    report << "\n";
+}
@@ -0,0 +1,69 @@
+# Runs one test program and compares its output with the expected file.
+# Invoked by CTest (see CMakeLists.txt) as
+#
+#   cmake -DCOMPILER=<compiler> -DMODE=<mode> -DNAME=<program>
+#         -DRESOURCES=<tests/resources> -DWORK_DIR=<scratch directory>
+#         [-DC_COMPILER=<cc>] [-DRUNTIME=<runtime/runtime.c>]
+#         -P check_output.cmake
+#
+# MODE is one of
+#   run       compiler <program> --run
+#   optimize  compiler <program> -O --run
+#   c         compiler <program> -O --emit-c, built with C_COMPILER
+#   asm       compiler <program> -O --emit-asm, linked with RUNTIME
+#
+# The program reads <RESOURCES>/expected/<NAME>.in as standard input when
+# that file exists; its standard output must equal <NAME>.out exactly.
+
+set(input ${RESOURCES}/input/${NAME}.code)
+set(expected ${RESOURCES}/expected/${NAME}.out)
+set(stdin ${RESOURCES}/expected/${NAME}.in)
+if(NOT EXISTS ${stdin})
+    set(stdin /dev/null)
+endif()
+
+set(work ${WORK_DIR}/${NAME}-${MODE})
+file(MAKE_DIRECTORY ${work})
+
+# Fails the test with the command's output when it did not succeed
+function(run_step)
+    execute_process(COMMAND ${ARGN}
+                    RESULT_VARIABLE result
+                    OUTPUT_VARIABLE output
+                    ERROR_VARIABLE output)
+    if(NOT result EQUAL 0)
+        string(REPLACE ";" " " command "${ARGN}")
+        message(FATAL_ERROR "${command} failed (${result}):\n${output}")
+    endif()
+endfunction()
+
+if(MODE STREQUAL "run")
+    set(program ${COMPILER} ${input} --run)
+elseif(MODE STREQUAL "optimize")
+    set(program ${COMPILER} ${input} -O --run)
+elseif(MODE STREQUAL "c")
+    run_step(${COMPILER} ${input} -O --emit-c ${work}/program.c)
+    run_step(${C_COMPILER} -O2 ${work}/program.c -lm -o ${work}/program)
+    set(program ${work}/program)
+elseif(MODE STREQUAL "asm")
+    run_step(${COMPILER} ${input} -O --emit-asm ${work}/program.s)
+    run_step(${C_COMPILER} ${work}/program.s ${RUNTIME} -lm -o ${work}/program)
+    set(program ${work}/program)
+else()
+    message(FATAL_ERROR "Unknown MODE '${MODE}'")
+endif()
+
+execute_process(COMMAND ${program}
+                INPUT_FILE ${stdin}
+                RESULT_VARIABLE result
+                OUTPUT_VARIABLE actual
+                ERROR_VARIABLE errors)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${NAME} (${MODE}) exited with ${result}:\n${errors}")
+endif()
+
+file(READ ${expected} wanted)
+if(NOT actual STREQUAL wanted)
+    message(FATAL_ERROR "${NAME} (${MODE}): output differs from ${expected}\n"
+                        "--- expected\n${wanted}--- actual\n${actual}")
+endif()